@@ -0,0 +1,95 @@
+#pragma once
+#include <eosio/eosio.hpp>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace freedao {
+
+// Action arena
+// Temporary strings and vectors built during an action are allocated from a fixed buffer by bumping a pointer. The
+// buffer is part of the contract's static data, so it sits inside the initial memory pages - heap allocations would
+// grow the linear memory a page at a time, and the default allocator does not reuse freed memory. Linear memory is
+// reset for every action, so the arena starts empty each time; an allocation that does not fit falls back to the heap.
+
+constexpr size_t ARENA_BYTES = 8192;
+
+class action_arena {
+public:
+  void *allocate(size_t bytes) {
+    size_t offset = (used + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    if (offset + bytes > ARENA_BYTES) return ::operator new(bytes);
+
+    used = offset + bytes;
+    if (used > high_water) high_water = used;
+    return buffer + offset;
+  }
+
+  void deallocate(void *p) {
+    // arena memory is released all at once at the end of the action
+    if (!owns(p)) ::operator delete(p);
+  }
+
+  // the most of the buffer in use at once
+  size_t peak() const { return high_water; }
+
+private:
+  alignas(std::max_align_t) char buffer[ARENA_BYTES];
+  size_t used = 0;
+  size_t high_water = 0;
+
+  bool owns(void *p) const { return p >= buffer && p < buffer + ARENA_BYTES; }
+};
+
+inline action_arena arena;
+
+// allocator for standard containers
+template <typename T> struct arena_allocator {
+  using value_type = T;
+
+  arena_allocator() = default;
+  template <typename U> arena_allocator(const arena_allocator<U> &) {}
+
+  T *allocate(size_t n) { return static_cast<T *>(arena.allocate(n * sizeof(T))); }
+  void deallocate(T *p, size_t) { arena.deallocate(p); }
+
+  template <typename U> bool operator==(const arena_allocator<U> &) const { return true; }
+  template <typename U> bool operator!=(const arena_allocator<U> &) const { return false; }
+};
+
+using arena_string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+template <typename T> using arena_vector = std::vector<T, arena_allocator<T>>;
+
+// arena strings and vectors are packed as a std::string or std::vector, so they can be sent as action data
+template <typename Stream> eosio::datastream<Stream> &operator<<(eosio::datastream<Stream> &ds, const arena_string &s) {
+  ds << eosio::unsigned_int(s.size());
+  if (!s.empty()) ds.write(s.data(), s.size());
+  return ds;
+}
+
+template <typename Stream, typename T>
+eosio::datastream<Stream> &operator<<(eosio::datastream<Stream> &ds, const arena_vector<T> &v) {
+  ds << eosio::unsigned_int(v.size());
+  for (const auto &item : v) ds << item;
+  return ds;
+}
+
+// check with a message that is only built if the check fails
+template <typename F> void check_lazy(bool condition, F &&message) {
+  if (!condition) {
+    const auto &text = message();
+    eosio::check(false, text.data(), text.size());
+  }
+}
+
+#ifdef BENCH
+extern "C" void *sbrk(size_t bytes);
+
+// the top of the heap - linear memory never shrinks during an action, so at the end of it this is the peak
+inline size_t heap_peak() { return reinterpret_cast<size_t>(sbrk(0)); }
+#endif
+
+} // end of namespace freedao
@@ -19,7 +19,7 @@ void freeosgov::claim(name user) {
 
     require_auth(user);
 
-    tick();
+    rollover_check();
 
     uint32_t this_iteration = current_iteration();
     
@@ -178,4 +178,144 @@ void freeosgov::claim(name user) {
         });
     }
 
-} */
\ No newline at end of file
+} */
+
+// Merkle-root claim settlement
+// The reward list for an iteration is computed off chain from the archived participation data. Only its Merkle
+// root is published on chain, and each user claims their entry with a proof of O(log n) hashes.
+//
+// leaf = sha256(pack(index, user, iteration, amount))
+// node = sha256(left || right), with the list padded to a power of two using all-zero leaves
+// The entry index determines the path: bit n of the index is set when the node at level n is a right child.
+
+checksum256 merkle_leaf(uint32_t index, name user, uint32_t iteration, asset amount) {
+    // the packed leaf is hashed and dropped, so it is packed into the action arena
+    auto leaf = std::make_tuple(index, user, iteration, amount);
+    arena_vector<char> leaf_data(pack_size(leaf));
+    datastream<char *> ds(leaf_data.data(), leaf_data.size());
+    ds << leaf;
+    return sha256(leaf_data.data(), leaf_data.size());
+}
+
+checksum256 merkle_node(const checksum256 &left, const checksum256 &right) {
+    char node_data[64];
+    auto left_bytes = left.extract_as_byte_array();
+    auto right_bytes = right.extract_as_byte_array();
+    memcpy(node_data, left_bytes.data(), 32);
+    memcpy(node_data + 32, right_bytes.data(), 32);
+    return sha256(node_data, sizeof(node_data));
+}
+
+// depth of the tree holding the given number of leaves
+uint32_t merkle_depth(uint32_t leaves) {
+    uint32_t depth = 0;
+    while ((uint64_t(1) << depth) < leaves) depth++;
+    return depth;
+}
+
+// ACTION
+void freeosgov::claimroot(uint32_t iteration, checksum256 root, uint32_t leaves, asset total) {
+
+    require_auth(get_self());
+
+    check(iteration != 0 && iteration < current_iteration(), "claims are for previous iterations only");
+    check(leaves > 0, "reward list is empty");
+    check(total.symbol == POINT_CURRENCY_SYMBOL && total.is_valid() && total.amount > 0, "invalid reward total");
+
+    claimroots_index claimroots_table(get_self(), get_self().value);
+    auto claimroot_iterator = claimroots_table.find(iteration);
+
+    if (claimroot_iterator == claimroots_table.end()) {
+        claimroot_iterator = claimroots_table.emplace(get_self(), [&](auto &c) {
+            c.iteration = iteration;
+            c.root = root;
+            c.leaves = leaves;
+            c.total = total;
+            c.claimed = asset(0, POINT_CURRENCY_SYMBOL);
+            c.claims = 0;
+        });
+        ram_emplaced("claimroots"_n, *claimroot_iterator);
+    } else {
+        // a published root can only be corrected before anyone has claimed against it
+        check(claimroot_iterator->claimed.amount == 0, "rewards have already been claimed for this iteration");
+        claimroots_table.modify(claimroot_iterator, get_self(), [&](auto &c) {
+            c.root = root;
+            c.leaves = leaves;
+            c.total = total;
+        });
+    }
+}
+
+// ACTION
+void freeosgov::claimproof(name user, uint32_t iteration, uint32_t index, asset amount, vector<checksum256> proof) {
+
+    require_auth(user);
+
+    rollover_check();
+
+    claimroots_index claimroots_table(get_self(), get_self().value);
+    auto claimroot_iterator = claimroots_table.find(iteration);
+    check(claimroot_iterator != claimroots_table.end(), "rewards have not been published for this iteration");
+
+    check(index < claimroot_iterator->leaves, "reward index is out of range");
+    check(proof.size() == merkle_depth(claimroot_iterator->leaves), "proof has the wrong length");
+    check(amount.symbol == POINT_CURRENCY_SYMBOL && amount.is_valid() && amount.amount > 0, "invalid reward amount");
+
+    // has the entry already been claimed?
+    claimbits_index claimbits_table(get_self(), iteration);
+    uint64_t word = index / 64;
+    uint64_t mask = uint64_t(1) << (index % 64);
+    auto claimbits_iterator = claimbits_table.find(word);
+    check(claimbits_iterator == claimbits_table.end() || (claimbits_iterator->bits & mask) == 0,
+        "reward has already been claimed");
+
+    // walk the proof from the leaf to the root
+    checksum256 node = merkle_leaf(index, user, iteration, amount);
+    uint32_t position = index;
+    for (const checksum256 &sibling : proof) {
+        node = (position & 1) ? merkle_node(sibling, node) : merkle_node(node, sibling);
+        position >>= 1;
+    }
+    check(node == claimroot_iterator->root, "invalid reward proof");
+
+    check(claimroot_iterator->claimed + amount <= claimroot_iterator->total, "reward total exceeded");
+
+    // mark the entry as claimed
+    if (claimbits_iterator == claimbits_table.end()) {
+        claimbits_iterator = claimbits_table.emplace(get_self(), [&](auto &c) {
+            c.word = word;
+            c.bits = mask;
+        });
+        ram_emplaced("claimbits"_n, *claimbits_iterator);
+    } else {
+        claimbits_table.modify(claimbits_iterator, get_self(), [&](auto &c) {
+            c.bits |= mask;
+        });
+    }
+
+    claimroots_table.modify(claimroot_iterator, get_self(), [&](auto &c) {
+        c.claimed += amount;
+        c.claims += 1;
+    });
+
+    // add the reward to the user's tally and the leaderboard
+    if constexpr (leaderboard_module::enabled) {
+        record_participation(user, 0, amount);
+    }
+    record_activity(user, current_iteration());
+
+    // pay the reward from the contract's balance
+    name token_account = name(get_parameter(name("claimtoken")));
+
+    // the memo is built in the action arena - the user's name is written straight into it
+    char user_name[13];
+    arena_string memo("claim by ");
+    memo.append(user_name, user.write_as_string(user_name, user_name + sizeof(user_name)));
+
+    action transfer_action = action(
+        permission_level{get_self(), "active"_n}, token_account,
+        "transfer"_n,
+        std::make_tuple(get_self(), user, amount, memo));
+
+    transfer_action.send();
+}
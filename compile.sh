@@ -1 +1,27 @@
-eosio-cpp -o votemvp.wasm votemvp.cpp -DFREEOSCONFIG="\"freeoscfg5\"" -DFREEBY="\"freeby\"" -DFREEOS="\"freeostokens\"" --abigen
+#!/bin/sh
+# usage: compile.sh [release]
+#
+# The default build is the development build. 'release' builds a size-optimised, stripped wasm in build/release and
+# reports the size and instruction count of each function against the previous release build (needs binaryen's
+# wasm-opt and wabt's wasm-objdump).
+
+if [ "$1" = "release" ]; then
+  set -e
+  mkdir -p build/release
+  eosio-cpp -O=z -o build/release/votemvp.full.wasm votemvp.cpp -DFREEOSCONFIG="\"freeoscfg5\"" -DFREEBY="\"freeby\"" -DFREEOS="\"freeostokens\"" --abigen
+
+  # optimise for size and remove unreferenced functions, keeping the names for the report - limited to the MVP
+  # feature set, as newer opcodes such as sign-extension are rejected by the EOSIO wasm validator
+  wasm-opt --mvp-features -Oz --debuginfo build/release/votemvp.full.wasm -o build/release/votemvp.named.wasm
+  # then strip the names and other custom sections for deployment
+  wasm-opt --mvp-features --strip-debug --strip-producers build/release/votemvp.named.wasm -o build/release/votemvp.wasm
+  mv build/release/votemvp.full.abi build/release/votemvp.abi
+
+  if [ -f build/release/size.tsv ]; then mv build/release/size.tsv build/release/size.prev.tsv; fi
+  tools/size/size_report.sh build/release/votemvp.named.wasm build/release/size.tsv build/release/size.prev.tsv
+
+  rm build/release/votemvp.full.wasm build/release/votemvp.named.wasm
+  ls -l build/release/votemvp.wasm
+else
+  eosio-cpp -o votemvp.wasm votemvp.cpp -DFREEOSCONFIG="\"freeoscfg5\"" -DFREEBY="\"freeby\"" -DFREEOS="\"freeostokens\"" --abigen
+fi
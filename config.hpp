@@ -4,108 +4,250 @@
 #include "votemvp.hpp"
 #include "constants.hpp"
 
+#include <algorithm>
+
 using namespace eosio;
 using namespace freedao;
 
-// get string parameter value
-string freeosgov::get_parameter(name paramname) {
+// a string parameter's value, or nullopt if it is not set - read at most once per action
+// returned by value, as an upsert or erase later in the action drops the cached copy
+std::optional<string> freeosgov::parameter_value(name paramname) {
+  count_lookup();
+  auto cached = context.parameters.find(paramname.value);
+  if (cached != context.parameters.end()) return cached->second;
+
+  count_read();
   parameters_index parameters_table(get_self(), get_self().value);
   auto parameter_iterator = parameters_table.find(paramname.value);
 
-  std::string assert_msg = paramname.to_string() + " is not defined in the parameters table";
-  check(parameter_iterator != parameters_table.end(), assert_msg);
+  std::optional<string> value;
+  if (parameter_iterator != parameters_table.end()) value = parameter_iterator->value;
+  return context.parameters[paramname.value] = value;
+}
+
+// get string parameter value - the parameter must be set
+string freeosgov::get_parameter(name paramname) {
+  std::optional<string> value = parameter_value(paramname);
+  check_lazy(value.has_value(), [&] { return paramname.to_string() + " is not defined in the parameters table"; });
+  return *value;
+}
 
-  return parameter_iterator->value;
+// get string parameter value, or the default when it is not set
+string freeosgov::get_parameter_or(name paramname, const string &fallback) {
+  std::optional<string> value = parameter_value(paramname);
+  return value ? *value : fallback;
 }
 
-// get double parameter value
+// get numeric parameter value, or the default when it is not set
+uint32_t freeosgov::get_parameter_or(name paramname, uint32_t fallback) {
+  std::optional<string> value = parameter_value(paramname);
+  return value ? stoi(*value) : fallback;
+}
+
+// get double parameter value - read at most once per action
 double freeosgov::get_dparameter(name paramname) {
+  count_lookup();
+  auto cached = context.dparameters.find(paramname.value);
+  if (cached != context.dparameters.end()) return cached->second;
+
+  count_read();
   dparameters_index dparameters_table(get_self(), get_self().value);
   auto dparameter_iterator = dparameters_table.find(paramname.value);
 
-  std::string assert_msg = paramname.to_string() + " is not defined in the dparameters table";
-  check(dparameter_iterator != dparameters_table.end(), assert_msg);
+  check_lazy(dparameter_iterator != dparameters_table.end(),
+             [&] { return paramname.to_string() + " is not defined in the dparameters table"; });
 
-  return dparameter_iterator->value;
+  return context.dparameters[paramname.value] = dparameter_iterator->value;
 }
 
 
-// ACTION
-void freeosgov::paramupsert(name paramname, std::string value) {
+// insert or update a string parameter
+// returns true if the parameter was inserted
+bool freeosgov::parameter_upsert(parameters_index &parameters_table, name paramname, const string &value) {
+  context.parameters.erase(paramname.value);
 
-  require_auth(get_self());
-  parameters_index parameters_table(get_self(), get_self().value);
   auto parameter_iterator = parameters_table.find(paramname.value);
 
   // check if the parameter is in the table or not
   if (parameter_iterator == parameters_table.end()) {
     // the parameter is not in the table, so insert
-    parameters_table.emplace(get_self(), [&](auto &parameter) {
+    parameter_iterator = parameters_table.emplace(get_self(), [&](auto &parameter) {
       parameter.paramname = paramname;
       parameter.value = value;
     });
+    ram_emplaced("parameters"_n, *parameter_iterator);
+    return true;
 
   } else {
     // the parameter is in the table, so update
+    int64_t old_size = pack_size(*parameter_iterator);
     parameters_table.modify(parameter_iterator, get_self(), [&](auto &parameter) {
       parameter.value = value;
     });
+    ram_resized("parameters"_n, pack_size(*parameter_iterator) - old_size);
+    return false;
   }
 }
 
-// erase parameter from the table
-// ACTION
-void freeosgov::paramerase(name paramname) {
-  require_auth(_self);
+// erase a string parameter - the caller has checked that it exists
+void freeosgov::parameter_erase(parameters_index &parameters_table, name paramname) {
+  context.parameters.erase(paramname.value);
 
-  parameters_index parameters_table(get_self(), get_self().value);
   auto parameter_iterator = parameters_table.find(paramname.value);
 
-  // check if the parameter is in the table or not
-  check(parameter_iterator != parameters_table.end(),
-        "config parameter does not exist");
-
-  // the parameter is in the table, so delete
+  ram_erased("parameters"_n, *parameter_iterator);
   parameters_table.erase(parameter_iterator);
 }
 
-// ACTION
-void freeosgov::dparamupsert(name paramname, double dvalue) {
+// insert or update a double parameter
+// returns true if the parameter was inserted
+bool freeosgov::dparameter_upsert(dparameters_index &dparameters_table, name paramname, double dvalue) {
+  context.dparameters.erase(paramname.value);
 
-  require_auth(get_self());
-  dparameters_index dparameters_table(get_self(), get_self().value);
   auto dparameter_iterator = dparameters_table.find(paramname.value);
 
   // check if the parameter is in the table or not
   if (dparameter_iterator == dparameters_table.end()) {
     // the parameter is not in the table, so insert
-    dparameters_table.emplace(get_self(), [&](auto &dparameter) {
+    dparameter_iterator = dparameters_table.emplace(get_self(), [&](auto &dparameter) {
       dparameter.paramname = paramname;
       dparameter.value = dvalue;
     });
+    ram_emplaced("dparameters"_n, *dparameter_iterator);
+    return true;
 
   } else {
     // the parameter is in the table, so update
     dparameters_table.modify(dparameter_iterator, get_self(), [&](auto &dparameter) {
       dparameter.value = dvalue;
     });
+    return false;
   }
 }
 
+// erase a double parameter - the caller has checked that it exists
+void freeosgov::dparameter_erase(dparameters_index &dparameters_table, name paramname) {
+  context.dparameters.erase(paramname.value);
+
+  auto dparameter_iterator = dparameters_table.find(paramname.value);
+
+  ram_erased("dparameters"_n, *dparameter_iterator);
+  dparameters_table.erase(dparameter_iterator);
+}
+
+
+// ACTION
+param_receipt freeosgov::paramupsert(name paramname, std::string value) {
+
+  require_auth(get_self());
+  parameters_index parameters_table(get_self(), get_self().value);
+
+  bool created = parameter_upsert(parameters_table, paramname, value);
+
+  return param_receipt{paramname, "upsert"_n, created};
+}
+
+// erase parameter from the table
+// ACTION
+param_receipt freeosgov::paramerase(name paramname) {
+  require_auth(_self);
+
+  parameters_index parameters_table(get_self(), get_self().value);
+
+  // check if the parameter is in the table or not
+  check(parameters_table.find(paramname.value) != parameters_table.end(),
+        "config parameter does not exist");
+
+  parameter_erase(parameters_table, paramname);
+
+  return param_receipt{paramname, "erase"_n, false};
+}
+
+// ACTION
+param_receipt freeosgov::dparamupsert(name paramname, double dvalue) {
+
+  require_auth(get_self());
+  dparameters_index dparameters_table(get_self(), get_self().value);
+
+  bool created = dparameter_upsert(dparameters_table, paramname, dvalue);
+
+  return param_receipt{paramname, "upsert"_n, created};
+}
+
 // erase dparameter from the table
 // ACTION
-void freeosgov::dparamerase(name paramname) {
+param_receipt freeosgov::dparamerase(name paramname) {
   require_auth(_self);
 
   dparameters_index dparameters_table(get_self(), get_self().value);
-  auto dparameter_iterator = dparameters_table.find(paramname.value);
 
   // check if the parameter is in the table or not
-  check(dparameter_iterator != dparameters_table.end(),
+  check(dparameters_table.find(paramname.value) != dparameters_table.end(),
         "double parameter does not exist");
 
-  // the parameter is in the table, so delete
-  dparameters_table.erase(dparameter_iterator);
+  dparameter_erase(dparameters_table, paramname);
+
+  return param_receipt{paramname, "erase"_n, false};
+}
+
+// apply a batch of parameter changes in one pass - every change is validated before any is applied
+// ACTION
+batch_receipt freeosgov::parambatch(vector<param_change> changes) {
+  require_auth(get_self());
+
+  check(!changes.empty(), "no parameter changes");
+
+  parameters_index parameters_table(get_self(), get_self().value);
+  dparameters_index dparameters_table(get_self(), get_self().value);
+
+  // validate
+  std::vector<std::pair<bool, uint64_t>> changed;
+  for (const auto &change : changes) {
+    check(change.op == "upsert"_n || change.op == "erase"_n, "parameter change must be upsert or erase");
+
+    if (change.op == "erase"_n) {
+      if (change.isdouble) {
+        check(dparameters_table.find(change.paramname.value) != dparameters_table.end(),
+              "double parameter does not exist");
+      } else {
+        check(parameters_table.find(change.paramname.value) != parameters_table.end(),
+              "config parameter does not exist");
+      }
+    }
+
+    changed.emplace_back(change.isdouble, change.paramname.value);
+  }
+
+  // each parameter may only be changed once, so the order of the changes does not matter
+  std::sort(changed.begin(), changed.end());
+  check(std::adjacent_find(changed.begin(), changed.end()) == changed.end(),
+        "parameter is changed more than once in the batch");
+
+  // apply
+  batch_receipt receipt{0, 0};
+  for (const auto &change : changes) {
+    if (change.op == "upsert"_n) {
+      receipt.upserted++;
+    } else {
+      receipt.erased++;
+    }
+
+    if (change.isdouble) {
+      if (change.op == "upsert"_n) {
+        dparameter_upsert(dparameters_table, change.paramname, change.dvalue);
+      } else {
+        dparameter_erase(dparameters_table, change.paramname);
+      }
+    } else {
+      if (change.op == "upsert"_n) {
+        parameter_upsert(parameters_table, change.paramname, change.value);
+      } else {
+        parameter_erase(parameters_table, change.paramname);
+      }
+    }
+  }
+
+  return receipt;
 }
 
 
@@ -189,10 +331,9 @@ void freeosgov::burnererase(name account) {
 void freeosgov::currentrate(double price) {
 
   // check if the exchange account is calling this action, or the contract itself
-  parameters_index parameters_table(get_self(), get_self().value);
-  auto parameter_iterator = parameters_table.find(name("exchangeacc").value);
-  if (parameter_iterator != parameters_table.end()) {
-    require_auth(name(parameter_iterator->value));
+  string exchange_account = get_parameter_or(name("exchangeacc"), string());
+  if (!exchange_account.empty()) {
+    require_auth(name(exchange_account));
   } else {
     require_auth(get_self());
   }
@@ -2,46 +2,48 @@
 
 using namespace std;
 
-#define _STRINGIZE(x) #x
-#define STRINGIZE(x) _STRINGIZE(x)
-
-std::string freeby_acct = STRINGIZE(FREEBY);
-std::string freeos_acct = STRINGIZE(FREEOS);
+// Account constants - FREEBY and FREEOS are string literals passed by compile.sh, e.g. -DFREEBY="\"freeby\""
+// constexpr, so they are resolved at compile time rather than constructed when the contract is instantiated
+constexpr name FREEBY_ACCT = name(FREEBY);
+constexpr name FREEOS_ACCT = name(FREEOS);
 
 // Currency constants
-const string STAKE_CURRENCY_CODE = "XPR";
+constexpr symbol_code STAKE_CURRENCY_CODE = symbol_code("XPR");
 const uint8_t STAKE_CURRENCY_PRECISION = 4;
-const symbol STAKE_CURRENCY_SYMBOL = symbol(STAKE_CURRENCY_CODE, STAKE_CURRENCY_PRECISION);
+constexpr symbol STAKE_CURRENCY_SYMBOL = symbol(STAKE_CURRENCY_CODE, STAKE_CURRENCY_PRECISION);
 
-const string POINT_CURRENCY_CODE = "POINT";
+constexpr symbol_code POINT_CURRENCY_CODE = symbol_code("POINT");
 const uint8_t POINT_CURRENCY_PRECISION = 4;
-const symbol POINT_CURRENCY_SYMBOL = symbol(POINT_CURRENCY_CODE, POINT_CURRENCY_PRECISION);
+constexpr symbol POINT_CURRENCY_SYMBOL = symbol(POINT_CURRENCY_CODE, POINT_CURRENCY_PRECISION);
 
-const string AIRKEY_CURRENCY_CODE = "AIRKEY";
+constexpr symbol_code AIRKEY_CURRENCY_CODE = symbol_code("AIRKEY");
 const uint8_t AIRKEY_CURRENCY_PRECISION = 0;
-const symbol AIRKEY_CURRENCY_SYMBOL = symbol(AIRKEY_CURRENCY_CODE, AIRKEY_CURRENCY_PRECISION);
+constexpr symbol AIRKEY_CURRENCY_SYMBOL = symbol(AIRKEY_CURRENCY_CODE, AIRKEY_CURRENCY_PRECISION);
 
-const string FREEBY_CURRENCY_CODE = "FREEBY";
+constexpr symbol_code FREEBY_CURRENCY_CODE = symbol_code("FREEBY");
 const uint8_t FREEBY_CURRENCY_PRECISION = 4;
-const symbol FREEBY_CURRENCY_SYMBOL = symbol(FREEBY_CURRENCY_CODE, FREEBY_CURRENCY_PRECISION);
+constexpr symbol FREEBY_CURRENCY_SYMBOL = symbol(FREEBY_CURRENCY_CODE, FREEBY_CURRENCY_PRECISION);
 
-const string FREEOS_CURRENCY_CODE = "FREEOS";
+constexpr symbol_code FREEOS_CURRENCY_CODE = symbol_code("FREEOS");
 const uint8_t FREEOS_CURRENCY_PRECISION = 4;
-const symbol FREEOS_CURRENCY_SYMBOL = symbol(FREEOS_CURRENCY_CODE, FREEOS_CURRENCY_PRECISION);
+constexpr symbol FREEOS_CURRENCY_SYMBOL = symbol(FREEOS_CURRENCY_CODE, FREEOS_CURRENCY_PRECISION);
 
 
-const name AIRCLAIM_CONTRACT = name("freeos5");     // TODO: we should not need for production as we are overwriting contract
+constexpr name AIRCLAIM_CONTRACT = name("freeos5");     // TODO: we should not need for production as we are overwriting contract
 
 #ifdef PRODUCTION
-const name VERIFICATION_CONTRACT = name("eosio.proton");
+constexpr name VERIFICATION_CONTRACT = name("eosio.proton");
 #else
-const name VERIFICATION_CONTRACT = name("freeosconfig");
+constexpr name VERIFICATION_CONTRACT = name("freeosconfig");
 #endif
 
 const uint32_t ITERATION_LENGTH_SECONDS = 604800; // 1 week
 
 const double HARD_EXCHANGE_RATE_FLOOR = 0.0167;
 
+// fixed-point scale for the exact vote sums (8 decimal places)
+const uint64_t VOTE_SCALE = 100000000;
+
 // user CLS amount hard floor (in the absence of uclsamount parameter)
 const int64_t UCLSAMOUNT = 3500000;
 
@@ -54,5 +56,45 @@ const double DAOSHARE = 0.07;
 // Issuance percentage (expressed as floating point) of CLS
 const double ISSUANCE_PROPORTION_OF_CLS = 0.000286;
 
+// poll types
+const uint8_t POLL_AVERAGE = 1;   // numeric response within a range, result is the average
+const uint8_t POLL_CHOICE = 2;    // one of a number of options, result is the most popular option
+
+// poll status
+const uint8_t POLL_OPEN = 0;
+const uint8_t POLL_CLOSED = 1;
+
+// maximum number of options in a choice poll
+const uint8_t POLL_MAX_CHOICES = 32;
+
+// number of expired polls finalised per cron call (in the absence of the pollbatch parameter)
+const uint32_t POLL_BATCH = 10;
+
+// number of iterations a user's participation records are kept after their last activity (in the absence of the retention parameter)
+const uint32_t RETENTION_ITERATIONS = 26;
+
+// number of users examined per sweep (in the absence of the sweepbudget parameter)
+const uint32_t SWEEP_BUDGET = 20;
+
+// approximate RAM billed per table row in addition to the packed row
+const int64_t RAM_ROW_OVERHEAD = 112;
+
+// number of leaderboard entries (in the absence of the lbsize parameter)
+const uint32_t LEADERBOARD_SIZE = 100;
+
+// number of users per airimport call (in the absence of the importbudget parameter)
+const uint32_t IMPORT_BUDGET = 50;
+
+// number of price observations in the TWAP window (in the absence of the twapsize parameter)
+const uint32_t TWAP_SLOTS = 24;
+
+// seconds after the latest price observation beyond which the TWAP is not used (in the absence of the twapmaxage
+// parameter)
+const uint32_t TWAP_MAX_AGE = 21600;
+
+// highest price the oracle accepts - well above any real price, and low enough that the scaled price and the TWAP
+// sums cannot overflow
+const double PRICE_CEILING = 1000000.0;
+
 // mint-fee-free allowance for AIRKEY holders
 const int AIRKEY_MINT_FEE_FREE_ALLOWANCE = 5000;
@@ -0,0 +1,62 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Per-action context
+// The contract object is constructed for each action, so the context it holds lasts for exactly one action. Rows that
+// an action needs in more than one place - the system record, parameters, the current iteration from the calendar
+// and users' registration records - are loaded into it on first use and handed out from it afterwards, so each is
+// read at most once per action.
+//
+// The system and vote records are changed in memory, and written back once when the contract object is destroyed at
+// the end of the action, however many times the action changed them - e.g. a cron that rolls the iteration over
+// resets the vote record and moves the system record on, then closes polls and sweeps with the records as changed.
+// They must only be read and changed through the accessors below, never through a table of their own.
+
+// write back the records changed during the action
+freeosgov::~freeosgov() {
+  context.system_row.flush(get_self());
+  context.vote_row.flush(get_self());
+  ram_flush();
+
+#ifdef BENCH
+  // memory used, and context lookups and the reads made for them, read by tools/bench
+  print("heap ", heap_peak(), " arena ", arena.peak(), " lookups ", context_lookups, " reads ", context_reads);
+#endif
+}
+
+// the system table, constructed once per action - for creating the system record
+system_index &freeosgov::system_records() {
+  return context.system_row.table(get_self());
+}
+
+// the system record, loaded once per action
+const freedao::system &freeosgov::system_record() {
+  return context.system_row.get(get_self(), "system record is undefined");
+}
+
+// change the system record
+template <typename F> void freeosgov::system_update(F &&updater) {
+  context.system_row.modify(get_self(), "system record is undefined", updater);
+}
+
+// the vote table, constructed once per action - for creating the vote record
+vote_index &freeosgov::vote_records() {
+  return context.vote_row.table(get_self());
+}
+
+// the vote record, loaded once per action
+const vote_record &freeosgov::voting_record() {
+  return context.vote_row.get(get_self(), "vote record is undefined");
+}
+
+// change the vote record
+template <typename F> void freeosgov::vote_update(F &&updater) {
+  context.vote_row.modify(get_self(), "vote record is undefined", updater);
+}
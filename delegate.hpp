@@ -0,0 +1,101 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// ACTION
+void freeosgov::delegate(name user, name proxy) {
+
+    require_auth(user);
+
+    rollover_check();
+
+    check(user != proxy, "user cannot delegate to themselves");
+    check(is_account(proxy), "proxy account does not exist");
+
+    // is the user staked?
+    check(is_staked(user), "delegation is not open to unstaked users");
+
+    // is the system operational?
+    uint32_t this_iteration = current_iteration();
+    check(this_iteration != 0, "the freeos system is not available at this time");
+
+    // has the user already delegated?
+    delegation_index delegation_table(get_self(), user.value);
+    check(delegation_table.begin() == delegation_table.end(), "user has already delegated their vote");
+
+    // delegations are one level deep - a proxy cannot delegate, and a delegator cannot be a proxy
+    proxies_index proxies_table(get_self(), get_self().value);
+    check(proxies_table.find(user.value) == proxies_table.end(), "a proxy cannot delegate their vote");
+
+    delegation_index proxy_delegation_table(get_self(), proxy.value);
+    check(proxy_delegation_table.begin() == proxy_delegation_table.end(), "proxy has delegated their own vote");
+
+    // the proxy's weight is applied when they vote, so it cannot change once they have voted
+    check(!has_voted(proxy, this_iteration), "proxy has already voted in this iteration");
+    check(!has_voted(user, this_iteration), "user has already voted in this iteration");
+
+    // record the delegation
+    auto delegation_iterator = delegation_table.emplace(get_self(), [&](auto &d) {
+        d.proxy = proxy;
+        d.delegated_iteration = this_iteration;
+    });
+    ram_emplaced("delegations"_n, *delegation_iterator);
+
+    // add the user's vote to the proxy's running total
+    auto proxy_iterator = proxies_table.find(proxy.value);
+    if (proxy_iterator == proxies_table.end()) {
+        proxy_iterator = proxies_table.emplace(get_self(), [&](auto &p) {
+            p.account = proxy;
+            p.delegators = 1;
+            p.delegations = 1;
+        });
+        ram_emplaced("proxies"_n, *proxy_iterator);
+    } else {
+        proxies_table.modify(proxy_iterator, get_self(), [&](auto &p) {
+            p.delegators += 1;
+            p.delegations += 1;
+        });
+    }
+}
+
+// ACTION
+void freeosgov::undelegate(name user) {
+
+    require_auth(user);
+
+    rollover_check();
+
+    uint32_t this_iteration = current_iteration();
+
+    delegation_index delegation_table(get_self(), user.value);
+    auto delegation_iterator = delegation_table.begin();
+    check(delegation_iterator != delegation_table.end(), "user has not delegated their vote");
+
+    name proxy = delegation_iterator->proxy;
+
+    // the user's vote has already been cast by the proxy in this iteration
+    check(!has_voted(proxy, this_iteration), "proxy has already voted in this iteration");
+
+    // remove the user's vote from the proxy's running total
+    proxies_index proxies_table(get_self(), get_self().value);
+    auto proxy_iterator = proxies_table.find(proxy.value);
+    check(proxy_iterator != proxies_table.end(), "proxy record is undefined");
+
+    if (proxy_iterator->delegators <= 1) {
+        ram_erased("proxies"_n, *proxy_iterator);
+        proxies_table.erase(proxy_iterator);
+    } else {
+        proxies_table.modify(proxy_iterator, get_self(), [&](auto &p) {
+            p.delegators -= 1;
+        });
+    }
+
+    ram_erased("delegations"_n, *delegation_iterator);
+    delegation_table.erase(delegation_iterator);
+}
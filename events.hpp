@@ -0,0 +1,24 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Events
+// These actions do nothing - they are sent inline by the contract so that each vote and rollover appears in the
+// action traces with its results, and indexers can follow the state-history stream instead of polling tables.
+
+// ACTION
+void freeosgov::logvote(name user, uint32_t iteration, double q3response, bool amendment, uint32_t weight,
+                        uint32_t participants, uint32_t total_weight, double q3average) {
+  require_auth(get_self());
+}
+
+// ACTION
+void freeosgov::logrollover(uint32_t old_iteration, uint32_t new_iteration, uint32_t participants,
+                            uint32_t voters, uint32_t vote_weight, double locking_threshold, bool quorum) {
+  require_auth(get_self());
+}
@@ -5,6 +5,7 @@
 #include "constants.hpp"
 #include "config.hpp"
 #include "tables.hpp"
+#include "views.hpp"
 
 #include <stdlib.h>
 
@@ -43,28 +44,13 @@ string get_account_type(name user) {  // TODO: rewrite to look in freeosclaim us
   // contract then use that one
   name verification_contract = VERIFICATION_CONTRACT;
 
-  // access the verification table
-  usersinfo verification_table(name(verification_contract),
-                               name(verification_contract).value);
-  auto verification_iterator = verification_table.find(user.value);
+  // access the verification table - only the verification fields are decoded
+  userinfo_view verification(verification_contract, user);
 
-  if (verification_iterator != verification_table.end()) {
+  if (verification.exists()) {
     // record found, so default account_type is 'd', unless we find a
     // verification
-    user_account_type = "d";
-
-    auto kyc_prov = verification_iterator->kyc;
-
-    for (int i = 0; i < kyc_prov.size(); i++) {
-      size_t fn_pos = kyc_prov[i].kyc_level.find("firstname");
-      size_t ln_pos = kyc_prov[i].kyc_level.find("lastname");
-
-      if (verification_iterator->verified == true &&
-          fn_pos != std::string::npos && ln_pos != std::string::npos) {
-        user_account_type = "v";
-        break;
-      }
-    }
+    user_account_type = verification.name_verified() ? "v" : "d";
   }
 
   return user_account_type;
@@ -130,7 +116,7 @@ void freeosgov::reguser(name user) {  // TODO: detect if the user has an existin
   accounts accounts_table(get_self(), user.value);
   mintfeefree_index mintfeefree_table(get_self(), user.value);
 
-  auto points_iterator = accounts_table.find(symbol_code(POINT_CURRENCY_CODE).raw());
+  auto points_iterator = accounts_table.find(POINT_CURRENCY_CODE.raw());
   if (points_iterator != accounts_table.end()) {    
       // get and store the POINTs balance
       asset points_balance = points_iterator->balance;
@@ -152,7 +138,7 @@ void freeosgov::reguser(name user) {  // TODO: detect if the user has an existin
   }
 
   // check if the user has an AIRKEY - in which case they get a mint-fee-free waiver of mint-fee on their POINTs  
-  auto airkey_iterator = accounts_table.find(symbol_code(AIRKEY_CURRENCY_CODE).raw());
+  auto airkey_iterator = accounts_table.find(AIRKEY_CURRENCY_CODE.raw());
   if (airkey_iterator != accounts_table.end()) {
     // store mint-fee-free allowance in the mint_fee_free table
     asset airkey_allowance = asset(AIRKEY_MINT_FEE_FREE_ALLOWANCE * 10000, POINT_CURRENCY_SYMBOL);
@@ -271,38 +257,38 @@ void freeosgov::reregister(name user) {
 // is user staked?
 bool freeosgov::is_staked(name user) {
 
+  // the registration records are read at most once per action
+  count_lookup();
+  auto cached = context.staked.find(user.value);
+  if (cached != context.staked.end()) return cached->second;
+
   // default is false
   bool staked_status = false;
 
   // get the freeosclaim contract
   name registration_account = name(get_parameter(name("registeracct")));
 
-  airclaim_users_index users_table(registration_account, user.value);
-  auto user_iterator = users_table.begin();
-
-  check(user_iterator != users_table.end(), "user is not registered with Freeos");
+  // only the fields needed are read from the AirClaim user record and AIRKEY balance
+  count_read();
+  airclaim_user_view user_record(registration_account, user);
 
-  // check if the user has an AIRKEY
-  asset user_airkey_balance =
-      asset(0, AIRKEY_CURRENCY_SYMBOL); // default = 0 AIRKEY
+  check(user_record.exists(), "user is not registered with Freeos");
 
-  accounts user_accounts(registration_account, user.value);
-  symbol_code airkey = symbol_code(AIRKEY_CURRENCY_CODE);
-  auto user_airkey_account = user_accounts.find(airkey.raw());
-
-  if (user_airkey_account != user_accounts.end()) {
-    user_airkey_balance = user_airkey_account->balance;
-  }
+  // check if the user has an AIRKEY - default = 0 AIRKEY
+  count_read();
+  balance_view user_airkey_balance(registration_account, user, AIRKEY_CURRENCY_CODE);
 
   // Possession of an AIRKEY allows the user to bypass the staking requirement
-  if (user_airkey_balance.amount == 0) {
+  if (user_airkey_balance.amount() == 0) {
     // check the user record to see if the user staked
-    uint32_t staked_iteration = user_iterator->staked_iteration;
+    uint32_t staked_iteration = user_record.staked_iteration();
 
     if (staked_iteration > 0) staked_status = true;
   } else {
     staked_status = true;
   }
 
+  context.staked[user.value] = staked_status;
+
   return staked_status;
 }
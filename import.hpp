@@ -0,0 +1,105 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// AirClaim import
+// The AirClaim users table is scoped by user and scopes cannot be enumerated on chain, so the operator supplies the
+// accounts - in ascending order, in chunks of at most importbudget. The 'airimport' cursor records the last account
+// imported, so a chunk that is pushed again (or overlaps the previous one) is skipped rather than imported twice.
+
+// ACTION
+import_receipt freeosgov::airimport(vector<name> users) {
+
+    require_auth(get_self());
+
+    check(current_iteration() != 0, "The freeos system is not yet available");
+
+    // get the budget
+    uint32_t budget = get_parameter_or(name("importbudget"), IMPORT_BUDGET);
+    check_lazy(!users.empty() && users.size() <= budget, [&] { return "number of users must be between 1 and " + to_string(budget); });
+
+    // resume from the cursor
+    cursors_index cursors_table(get_self(), get_self().value);
+    auto cursor_iterator = cursors_table.find(name("airimport").value);
+    if (cursor_iterator == cursors_table.end()) {
+        cursor_iterator = cursors_table.emplace(get_self(), [&](auto &c) {
+            c.job = name("airimport");
+            c.position = 0;
+            c.processed = 0;
+            c.calls = {0, 0};
+        });
+        ram_emplaced("cursors"_n, *cursor_iterator);
+    }
+
+    name registration_account = name(get_parameter(name("registeracct")));
+    uint32_t this_iteration = current_iteration();
+
+    import_receipt receipt{0, 0, 0};
+    uint64_t position = cursor_iterator->position;
+
+    for (size_t i = 0; i < users.size(); i++) {
+        name user = users[i];
+        check(i == 0 || users[i - 1] < user, "users must be in ascending order");
+
+        // imported by an earlier call
+        if (user.value <= cursor_iterator->position) {
+            receipt.skipped++;
+            continue;
+        }
+        position = user.value;
+
+        airclaim_users_index airclaim_table(registration_account, user.value);
+        auto airclaim_iterator = airclaim_table.begin();
+
+        users_index users_table(get_self(), user.value);
+
+        if (airclaim_iterator == airclaim_table.end() || users_table.begin() != users_table.end()) {
+            receipt.skipped++;
+            continue;
+        }
+
+        // registration and stake
+        auto user_iterator = users_table.emplace(get_self(), [&](auto &u) {
+            u.stake = airclaim_iterator->stake;
+            u.account_type = string(1, airclaim_iterator->account_type);
+            u.registered_iteration = airclaim_iterator->registered_iteration;
+            u.staked_iteration = airclaim_iterator->staked_iteration;
+            u.votes = airclaim_iterator->votes;
+            u.issuances = airclaim_iterator->issuances;
+            u.last_issuance = airclaim_iterator->last_issuance;
+            u.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
+        });
+        ram_emplaced("users"_n, *user_iterator);
+
+        // participation history - the user counts as active from the import, so is not swept straight away
+        if constexpr (leaderboard_module::enabled) {
+            record_participation(user, airclaim_iterator->votes, asset(0, POINT_CURRENCY_SYMBOL));
+        }
+        record_activity(user, this_iteration);
+
+        receipt.imported++;
+    }
+
+    // the number of users
+    if (receipt.imported > 0) {
+        system_update([&](auto &sys) {
+            sys.usercount += receipt.imported;
+        });
+    }
+
+    cursors_table.modify(cursor_iterator, get_self(), [&](auto &c) {
+        c.position = position;
+        c.processed += receipt.imported;
+        c.calls.add(system_record().iteration);
+    });
+    receipt.processed = cursor_iterator->processed;
+
+    return receipt;
+}
@@ -0,0 +1,124 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// add to the user's participation tally and update their place on the leaderboard
+void freeosgov::record_participation(name user, uint32_t votes, asset claimed) {
+    tally_index tally_table(get_self(), user.value);
+    auto tally_iterator = tally_table.begin();
+
+    if (tally_iterator == tally_table.end()) {
+        tally_iterator = tally_table.emplace(get_self(), [&](auto &t) {
+            t.votes = votes;
+            t.claimed = claimed;
+        });
+        ram_emplaced("tallies"_n, *tally_iterator);
+    } else {
+        tally_table.modify(tally_iterator, get_self(), [&](auto &t) {
+            t.votes += votes;
+            t.claimed += claimed;
+        });
+    }
+
+    leaderboard_update(user, tally_iterator->votes, tally_iterator->claimed);
+}
+
+// keep the leaderboard to the top K participants - O(log K) per update
+void freeosgov::leaderboard_update(name user, uint32_t votes, asset claimed) {
+    leaders_index leaders_table(get_self(), get_self().value);
+    auto leader_iterator = leaders_table.find(user.value);
+
+    // already on the leaderboard, so update in place
+    if (leader_iterator != leaders_table.end()) {
+        leaders_table.modify(leader_iterator, get_self(), [&](auto &l) {
+            l.votes = votes;
+            l.claimed = claimed;
+        });
+        return;
+    }
+
+    // get the leaderboard size
+    uint32_t capacity = get_parameter_or(name("lbsize"), LEADERBOARD_SIZE);
+
+    lbstate_index lbstate_table(get_self(), get_self().value);
+    auto lbstate_iterator = lbstate_table.begin();
+    if (lbstate_iterator == lbstate_table.end()) {
+        lbstate_iterator = lbstate_table.emplace(get_self(), [&](auto &s) { s.size = 0; });
+        ram_emplaced("lbstate"_n, *lbstate_iterator);
+    }
+    uint32_t size = lbstate_iterator->size;
+
+    auto score_index = leaders_table.get_index<"score"_n>();
+
+    // when the leaderboard is full, the user must beat the lowest entry, which is evicted
+    if (size >= capacity) {
+        auto lowest_iterator = score_index.begin();
+        if (lowest_iterator == score_index.end() ||
+            leader::leader_score(votes, claimed) <= lowest_iterator->get_score()) {
+            return;
+        }
+
+        // evict down to capacity (more than one only if lbsize has been reduced)
+        while (size >= capacity && lowest_iterator != score_index.end()) {
+            ram_erased("leaders"_n, *lowest_iterator);
+            lowest_iterator = score_index.erase(lowest_iterator);
+            size--;
+        }
+    }
+
+    leader_iterator = leaders_table.emplace(get_self(), [&](auto &l) {
+        l.user = user;
+        l.votes = votes;
+        l.claimed = claimed;
+    });
+    ram_emplaced("leaders"_n, *leader_iterator);
+    size++;
+
+    lbstate_table.modify(lbstate_iterator, get_self(), [&](auto &s) { s.size = size; });
+}
+
+// take the user off the leaderboard, e.g. when their tally is erased
+void freeosgov::leaderboard_remove(name user) {
+    leaders_index leaders_table(get_self(), get_self().value);
+    auto leader_iterator = leaders_table.find(user.value);
+    if (leader_iterator == leaders_table.end()) return;
+
+    ram_erased("leaders"_n, *leader_iterator);
+    leaders_table.erase(leader_iterator);
+
+    lbstate_index lbstate_table(get_self(), get_self().value);
+    auto lbstate_iterator = lbstate_table.begin();
+    if (lbstate_iterator != lbstate_table.end() && lbstate_iterator->size > 0) {
+        lbstate_table.modify(lbstate_iterator, get_self(), [&](auto &s) { s.size -= 1; });
+    }
+}
+
+// record the leaderboard at the end of an iteration
+void freeosgov::leaderboard_snapshot(uint32_t iteration) {
+    leaders_index leaders_table(get_self(), get_self().value);
+    auto score_index = leaders_table.get_index<"score"_n>();
+
+    lbsnapshots_index lbsnapshots_table(get_self(), iteration);
+
+    // the snapshot is only taken once per iteration
+    if (lbsnapshots_table.begin() != lbsnapshots_table.end()) return;
+
+    uint64_t rank = 1;
+    for (auto leader_iterator = score_index.rbegin(); leader_iterator != score_index.rend(); leader_iterator++) {
+        auto snapshot_iterator = lbsnapshots_table.emplace(get_self(), [&](auto &s) {
+            s.rank = rank;
+            s.user = leader_iterator->user;
+            s.votes = leader_iterator->votes;
+            s.claimed = leader_iterator->claimed;
+        });
+        ram_emplaced("lbsnapshots"_n, *snapshot_iterator);
+        rank++;
+    }
+}
@@ -1,427 +1,305 @@
-#include <ctime>
-
-// TODO: Remove this action in production version
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Table maintenance
+// Tables scoped by the contract are truncated or rewritten a bounded number of rows per call. Each call records its
+// place in the cursors table (keyed by the table name), so an operation of any size is completed by calling tableop
+// repeatedly until it reports done. Only one operation per table should be in progress at a time.
+//
+// Tables scoped by user are handled for the users listed in the call - at most 'budget' of them - which are listed
+// off chain from the table's scopes, so no user is missed. Tables scoped by a poll or an iteration (pollvotes,
+// claimbits and lbsnapshots) are handled one scope at a time, named in the call.
+//
+// State that depends on a table is kept in step with it: truncating the leaderboard resets its size, truncating the
+// TWAP also truncates its observations, erasing a delegation takes it off the proxy's total, and erasing or
+// resetting a tally takes the user off the leaderboard. A poll is erased after its votes and a claim root after its
+// claim bitmap, and neither scoped table can be truncated while its poll is open or its claim root exists, so no
+// vote or claim can be made twice. 'rewrite' re-serialises rows unchanged in the current layout.
+
+// erase up to 'budget' rows of a table in one scope - returns the number erased
+template <typename T>
+uint32_t freeosgov::table_truncate(name table, uint64_t scope, uint32_t budget) {
+    T t(get_self(), scope);
+    uint32_t erased = 0;
+
+    for (auto iterator = t.begin(); iterator != t.end() && erased < budget; erased++) {
+        ram_erased(table, *iterator);
+        iterator = t.erase(iterator);
+    }
 
-// ACTION
-/* maintenance actions - TODO: delete from production
-void freeosgov::maintain(string action, name user, vector<name> removees) {
+    return erased;
+}
 
-  require_auth(get_self());
+// erase up to 'budget' rows of a contract-scoped table, each after the rows of the table scoped by it - returns the
+// number erased from both
+template <typename Parent, typename Child>
+uint32_t freeosgov::table_truncate_linked(name table, name child, uint32_t budget) {
+    Parent t(get_self(), get_self().value);
+    uint32_t erased = 0;
 
-  if (action == "erase user") {
-    users_index users_table(get_self(), user.value);
-    auto user_iterator = users_table.begin();
+    for (auto iterator = t.begin(); iterator != t.end() && erased < budget; erased++) {
+        erased += table_truncate<Child>(child, iterator->primary_key(), budget - erased);
+        if (erased == budget) break;
 
-    if (user_iterator != users_table.end()) {
-      users_table.erase(user_iterator);
+        ram_erased(table, *iterator);
+        iterator = t.erase(iterator);
+    }
 
-      // decrement number of users
-      system_index system_table(get_self(), get_self().value);
-      auto system_iterator = system_table.begin();
-      check(system_iterator != system_table.end(), "system record is undefined");
+    return erased;
+}
+
+// rewrite up to 'budget' rows of a table in one scope, from primary key 'position' - returns the number rewritten and
+// moves 'position' to the next row, or to 0 at the end of the table
+template <typename T>
+uint32_t freeosgov::table_rewrite(name table, uint64_t scope, uint64_t &position, uint32_t budget) {
+    T t(get_self(), scope);
+    uint32_t rewritten = 0;
+
+    auto iterator = t.lower_bound(position);
+    for (; iterator != t.end() && rewritten < budget; iterator++, rewritten++) {
+        int64_t old_size = pack_size(*iterator);
+        t.modify(iterator, get_self(), [&](auto &row) {});
+        ram_resized(table, pack_size(*iterator) - old_size);
+    }
 
-      system_table.modify(system_iterator, get_self(), [&](auto &sys) {
-        sys.usercount = sys.usercount - 1;
-      });
+    position = iterator == t.end() ? 0 : iterator->primary_key();
+    return rewritten;
+}
+
+// rewrite the row of a single-row table - returns the number rewritten
+template <typename T>
+uint32_t freeosgov::row_rewrite(name table, uint64_t scope) {
+    T t(get_self(), scope);
+    auto iterator = t.begin();
+    if (iterator == t.end()) return 0;
+
+    int64_t old_size = pack_size(*iterator);
+    t.modify(iterator, get_self(), [&](auto &row) {});
+    ram_resized(table, pack_size(*iterator) - old_size);
+    return 1;
+}
+
+// apply an operation to a user-scoped table for one user - returns the number of rows changed
+uint32_t freeosgov::user_tableop(name table, name op, name user) {
+
+    if (op == "rewrite"_n) {
+        if (table == "svrs"_n) return row_rewrite<svr_index>(table, user.value);
+        if (table == "ballots"_n) return row_rewrite<ballot_index>(table, user.value);
+        if (table == "delegations"_n) return row_rewrite<delegation_index>(table, user.value);
+        if (table == "tallies"_n) return row_rewrite<tally_index>(table, user.value);
+        if (table == "users"_n) return row_rewrite<users_index>(table, user.value);
+        return 0;
     }
 
-  }
-
-  if (action == "clear users") {
-      users_index users_table_a(get_self(), name("analappleton").value);
-      auto iterator_a = users_table_a.begin();
-      users_table_a.erase(iterator_a);
-
-      users_index users_table_b(get_self(), name("billbeaumont").value);
-      auto iterator_b = users_table_b.begin();
-      users_table_b.erase(iterator_b);
-
-      users_index users_table_c(get_self(), name("celiacollins").value);
-      auto iterator_c = users_table_c.begin();
-      users_table_c.erase(iterator_c);
-
-      users_index users_table_d(get_self(), name("dennisedolan").value);
-      auto iterator_d = users_table_d.begin();
-      users_table_d.erase(iterator_d);
-
-      users_index users_table_e(get_self(), name("ethanedwards").value);
-      auto iterator_e = users_table_e.begin();
-      users_table_e.erase(iterator_e);
-
-      users_index users_table_f(get_self(), name("frankyfellon").value);
-      auto iterator_f = users_table_f.begin();
-      users_table_f.erase(iterator_f);
-  }
-
-  if (action == "restore users") {
-      // alanappleton
-      users_index users_table_a(get_self(), name("analappleton").value);
-      users_table_a.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.feefree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 1;
-        s.staked_iteration = 1;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 2;
-        s.total_issuance_amount = asset(120000, POINT_CURRENCY_SYMBOL);
-      });
-
-      // billbeaumont
-      users_index users_table_b(get_self(), name("billbeaumont").value);
-      users_table_b.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.feefree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 8;
-        s.staked_iteration = 8;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 0;
-        s.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
-      });
-
-      // celiacollins
-      users_index users_table_c(get_self(), name("celiacollins").value);
-      users_table_c.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.feefree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 8;
-        s.staked_iteration = 8;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 0;
-        s.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
-      });
-
-      // dennisedolan
-      users_index users_table_d(get_self(), name("dennisedolan").value);
-      users_table_c.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.feefree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 8;
-        s.staked_iteration = 8;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 0;
-        s.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
-      });
-
-      // ethanedwards
-      users_index users_table_e(get_self(), name("ethanedwards").value);
-      users_table_c.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.feefree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 8;
-        s.staked_iteration = 8;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 0;
-        s.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
-      });
-
-      // frankyfellon
-      users_index users_table_f(get_self(), name("frankyfellon").value);
-      users_table_c.emplace(get_self(), [&](auto &s) {
-        s.stake = asset(0, STAKE_CURRENCY_SYMBOL);
-        //s.mintfree_airclaim_points = asset(0, POINT_CURRENCY_SYMBOL);
-        s.account_type = "e";
-        s.registered_iteration = 8;
-        s.staked_iteration = 8;
-        s.votes = 0;
-        s.issuances = 0;
-        s.last_issuance = 0;
-        s.total_issuance_amount = asset(0, POINT_CURRENCY_SYMBOL);
-      });
-
-  }
-
-  if (action == "size user") {
-    check(false, sizeof(airclaim_user));
-  }
-
-  if (action == "clear survey") {
-    survey_index survey_table(get_self(), get_self().value);
-    auto survey_itr = survey_table.begin();
-
-    survey_table.erase(survey_itr);
-  }
-
-  if (action == "clear rewards") {
-    rewards_index rewards_table(get_self(), get_self().value);
-    auto rewards_iterator = rewards_table.begin();
-    while (rewards_iterator != rewards_table.end()) {
-      rewards_iterator = rewards_table.erase(rewards_iterator);
+    if (table == "svrs"_n && op == "reset"_n) {
+        svr_index svrs_table(get_self(), user.value);
+        auto svr_iterator = svrs_table.begin();
+        if (svr_iterator == svrs_table.end()) return 0;
+
+        svrs_table.modify(svr_iterator, get_self(), [&](auto &svr) {
+            svr = {};
+        });
+        return 1;
     }
-  }
 
-  if (action == "assetmax") {
-    check(false, to_string(asset::max_amount));
-  }
+    if (table == "tallies"_n) {
+        // the leaderboard is ranked on the tally
+        if constexpr (leaderboard_module::enabled) {
+            leaderboard_remove(user);
+        }
 
-  if (action == "svr inits") {
-    survey_init();
+        if (op == "truncate"_n) return table_truncate<tally_index>(table, user.value, 1);
 
-    vote_init();
+        tally_index tally_table(get_self(), user.value);
+        auto tally_iterator = tally_table.begin();
+        if (tally_iterator == tally_table.end()) return 0;
 
-    ratify_init();
-  }
+        tally_table.modify(tally_iterator, get_self(), [&](auto &t) {
+            t.votes = 0;
+            t.claimed.amount = 0;
+        });
+        return 1;
+    }
 
-  if (action == "victorvector survey") {
-    svr_index svrs_table(get_self(), user.value);
-    auto svr_iterator = svrs_table.begin();
-    if (svr_iterator == svrs_table.end()) {
-        // emplace
-        svrs_table.emplace(get_self(), [&](auto &svr) { ; });
-        svr_iterator = svrs_table.begin();
+    if (table == "delegations"_n) {
+        delegation_index delegation_table(get_self(), user.value);
+        auto delegation_iterator = delegation_table.begin();
+        if (delegation_iterator == delegation_table.end()) return 0;
+
+        // remove the user's vote from the proxy's running total
+        proxies_index proxies_table(get_self(), get_self().value);
+        auto proxy_iterator = proxies_table.find(delegation_iterator->proxy.value);
+        if (proxy_iterator != proxies_table.end()) {
+            if (proxy_iterator->delegators <= 1) {
+                ram_erased("proxies"_n, *proxy_iterator);
+                proxies_table.erase(proxy_iterator);
+            } else {
+                proxies_table.modify(proxy_iterator, get_self(), [&](auto &p) {
+                    p.delegators -= 1;
+                });
+            }
+        }
+
+        ram_erased("delegations"_n, *delegation_iterator);
+        delegation_table.erase(delegation_iterator);
+        return 1;
     }
-  }
-
-  if (action == "set cls") {
-    system_index system_table(get_self(), get_self().value);
-    auto system_iterator = system_table.begin();
-    check(system_iterator != system_table.end(), "system record is undefined");
-
-    system_table.modify(system_iterator, get_self(), [&](auto &sys) {
-      sys.cls = asset(231000000000, POINT_CURRENCY_SYMBOL);
-    });
-  }
-
-  if (action == "set usercount") {
-    system_index system_table(get_self(), get_self().value);
-    auto system_iterator = system_table.begin();
-    check(system_iterator != system_table.end(), "system record is undefined");
-
-    system_table.modify(system_iterator, get_self(), [&](auto &sys) {
-      sys.usercount = 1;
-    });
-  }
-
-  if (action == "system clear") {
-    system_index system_table(get_self(), get_self().value);
-    auto system_iterator = system_table.begin();
-    system_table.erase(system_iterator);
-  }
-
-  if (action == "system restore") {
-    system_index system_table(get_self(), get_self().value);
-    system_table.emplace(
-        get_self(), [&](auto &sys) {
-          sys.usercount = 22;
-          sys.cls = asset(654500000000, POINT_CURRENCY_SYMBOL);
-          sys.claimevents = 3;
-          sys.iteration = 3286;
-          sys.participants = 1;
-          //sys.init = time_point("2021-09-15T00:00:00.000");
-        });
-  }
-
-  if (action == "system restore2") {
-    system_index system_table(get_self(), get_self().value);
-    system_table.emplace(
-        get_self(), [&](auto &sys) {
-          sys.usercount = 4;
-          sys.cls = asset(0, POINT_CURRENCY_SYMBOL);
-          sys.claimevents = 0;
-          sys.iteration = 0;
-          sys.participants = 2;
-          //sys.init = time_point("2021-09-15T00:00:00.000");
-        });
-  }
-
-  if (action == "ucls") {
-    asset ucls = calculate_user_cls_addition();
-    check(false, ucls.to_string());
-  }
-
-  if (action == "participate") {
-    system_index system_table(get_self(), get_self().value);
-      auto system_iterator = system_table.begin();
-      check(system_iterator != system_table.end(), "system record is undefined");
-      system_table.modify(system_iterator, get_self(), [&](auto &s) {
-          s.participants += 1;
-      });
-  }
-
-  if (action == "is registered") {
-    if (is_registered(user)) {
-      check(false, "user is registered");
-    } else {
-      check(false, "user is not registered");
+
+    if (table == "users"_n) {
+        uint32_t erased = table_truncate<users_index>(table, user.value, 1);
+
+        // decrement number of users
+        if (erased > 0) {
+            system_update([&](auto &sys) {
+                sys.usercount -= erased;
+            });
+        }
+        return erased;
     }
-  }
 
-  if (action == "survey period") {
-    if (is_action_period("survey") == true) {
-      check(false, "In survey period");
+    if (table == "svrs"_n) return table_truncate<svr_index>(table, user.value, 1);
+    if (table == "ballots"_n) return table_truncate<ballot_index>(table, user.value, 1);
+
+    return 0;
+}
+
+// ACTION
+// truncate, reset or rewrite a table, a bounded number of rows (or listed users) per call - 'scope' is the poll or
+// iteration of a table scoped by one
+tableop_receipt freeosgov::tableop(name table, name op, uint32_t budget, uint64_t scope, vector<name> users) {
+
+    require_auth(get_self());
+
+    check(budget > 0, "budget must be positive");
+
+    bool user_scoped = table == "svrs"_n || table == "ballots"_n || table == "delegations"_n ||
+                       table == "tallies"_n || table == "users"_n;
+    bool contract_scoped = table == "actives"_n || table == "leaders"_n || table == "twap"_n || table == "stats"_n ||
+                           table == "proposals"_n || table == "claimroots"_n;
+    bool other_scoped = table == "pollvotes"_n || table == "claimbits"_n || table == "lbsnapshots"_n;
+
+    // linked tables are only handled together with the table they depend on
+    check(table != "proxies"_n, "proxies are maintained with delegations");
+    check(table != "priceobs"_n, "price observations are maintained with twap");
+
+    check(user_scoped || contract_scoped || other_scoped, "table is not supported");
+    if (op == "reset"_n) {
+        check(table == "svrs"_n || table == "tallies"_n, "table cannot be reset");
     } else {
-      check(false, "Outside of survey period");
+        check(op == "truncate"_n || op == "rewrite"_n, "operation must be truncate, reset or rewrite");
     }
-  }
 
-  if (action == "vote period") {
-    if (is_action_period("vote") == true) {
-      check(false, "In vote period");
-    } else {
-      check(false, "Outside of vote period");
+    tableop_receipt receipt{0, false, 0};
+
+    // users listed by the caller - the call is complete when they have been handled
+    if (user_scoped) {
+        check_lazy(!users.empty() && users.size() <= budget,
+                   [&] { return "number of users must be between 1 and " + to_string(budget); });
+
+        for (name user : users) {
+            receipt.rows += user_tableop(table, op, user);
+        }
+        receipt.done = true;
+        receipt.processed = receipt.rows;
+        return receipt;
     }
-  }
-  
-  if (action == "ratify period") {
-    if (is_action_period("ratify") == true) {
-      check(false, "In ratify period");
-    } else {
-      check(false, "Outside of ratify period");
+
+    check(users.empty(), "users are only listed for user-scoped tables");
+    check(other_scoped || scope == 0, "scope is only given for tables scoped by a poll or an iteration");
+
+    if (op == "truncate"_n && table == "pollvotes"_n) {
+        proposals_index proposals_table(get_self(), get_self().value);
+        auto proposal_iterator = proposals_table.find(scope);
+        check(proposal_iterator == proposals_table.end() || proposal_iterator->status == POLL_CLOSED,
+              "votes of an open poll cannot be truncated");
     }
-  }
 
-  if (action == "clear svr") {
-    svr_index svrs_table(get_self(), user.value);
-    auto svr_iterator = svrs_table.begin();
+    if (op == "truncate"_n && table == "claimbits"_n) {
+        claimroots_index claimroots_table(get_self(), get_self().value);
+        check(claimroots_table.find(scope) == claimroots_table.end(), "claim bits are truncated with their claim root");
+    }
 
-    if (svr_iterator == svrs_table.end()) {
-        // emplace
-        svrs_table.emplace(get_self(), [&](auto &svr) { ; });
-        svr_iterator = svrs_table.begin();
-    } else {
-        svrs_table.modify(svr_iterator, get_self(), [&](auto &svr) {
-          svr.survey0 = 0;
-          svr.survey1 = 0;
-          svr.survey2 = 0;
-          svr.survey3 = 0;
-          svr.survey4 = 0;
-          svr.vote0 = 0;
-          svr.vote1 = 0;
-          svr.vote2 = 0;
-          svr.vote3 = 0;
-          svr.vote4 = 0;
-          svr.ratify0 = 0;
-          svr.ratify1 = 0;
-          svr.ratify2 = 0;
-          svr.ratify3 = 0;
-          svr.ratify4 = 0;
+    // resume from the cursor
+    cursors_index cursors_table(get_self(), get_self().value);
+    auto cursor_iterator = cursors_table.find(table.value);
+    if (cursor_iterator == cursors_table.end()) {
+        cursor_iterator = cursors_table.emplace(get_self(), [&](auto &c) {
+            c.job = table;
+            c.position = 0;
+            c.processed = 0;
+            c.calls = {0, 0};
         });
+        ram_emplaced("cursors"_n, *cursor_iterator);
     }
-    
-  }
 
+    if (!other_scoped) scope = get_self().value;
+    uint64_t position = cursor_iterator->position;
+
+    if (op == "truncate"_n) {
+        if (table == "actives"_n) receipt.rows = table_truncate<actives_index>(table, scope, budget);
+        else if (table == "stats"_n) receipt.rows = table_truncate<stats_index>(table, scope, budget);
+        else if (table == "leaders"_n) {
+            receipt.rows = table_truncate<leaders_index>(table, scope, budget);
+
+            // keep the leaderboard size in step with its rows
+            lbstate_index lbstate_table(get_self(), get_self().value);
+            auto lbstate_iterator = lbstate_table.begin();
+            if (receipt.rows > 0 && lbstate_iterator != lbstate_table.end()) {
+                lbstate_table.modify(lbstate_iterator, get_self(), [&](auto &s) {
+                    s.size = s.size > receipt.rows ? s.size - receipt.rows : 0;
+                });
+            }
+        } else if (table == "twap"_n) {
+            // the observations first, then the running sums over them
+            receipt.rows = table_truncate<priceobs_index>("priceobs"_n, scope, budget);
+            if (receipt.rows < budget) receipt.rows += table_truncate<twap_index>(table, scope, budget - receipt.rows);
+        } else if (table == "proposals"_n) {
+            receipt.rows = table_truncate_linked<proposals_index, pollvotes_index>(table, "pollvotes"_n, budget);
+        } else if (table == "claimroots"_n) {
+            receipt.rows = table_truncate_linked<claimroots_index, claimbits_index>(table, "claimbits"_n, budget);
+        } else if (table == "pollvotes"_n) receipt.rows = table_truncate<pollvotes_index>(table, scope, budget);
+        else if (table == "claimbits"_n) receipt.rows = table_truncate<claimbits_index>(table, scope, budget);
+        else if (table == "lbsnapshots"_n) receipt.rows = table_truncate<lbsnapshots_index>(table, scope, budget);
+
+        // fewer rows than the budget means the table is now empty
+        receipt.done = receipt.rows < budget;
 
-  if (action == "set svr") {
-    svr_index svrs_table(get_self(), user.value);
-    auto svr_iterator = svrs_table.begin();
+    } else {
+        if (table == "actives"_n) receipt.rows = table_rewrite<actives_index>(table, scope, position, budget);
+        else if (table == "stats"_n) receipt.rows = table_rewrite<stats_index>(table, scope, position, budget);
+        else if (table == "leaders"_n) receipt.rows = table_rewrite<leaders_index>(table, scope, position, budget);
+        else if (table == "twap"_n) {
+            receipt.rows = table_rewrite<priceobs_index>("priceobs"_n, scope, position, budget);
+            if (position == 0 && receipt.rows < budget) receipt.rows += row_rewrite<twap_index>(table, scope);
+        } else if (table == "proposals"_n) receipt.rows = table_rewrite<proposals_index>(table, scope, position, budget);
+        else if (table == "claimroots"_n) receipt.rows = table_rewrite<claimroots_index>(table, scope, position, budget);
+        else if (table == "pollvotes"_n) receipt.rows = table_rewrite<pollvotes_index>(table, scope, position, budget);
+        else if (table == "claimbits"_n) receipt.rows = table_rewrite<claimbits_index>(table, scope, position, budget);
+        else if (table == "lbsnapshots"_n) receipt.rows = table_rewrite<lbsnapshots_index>(table, scope, position, budget);
+
+        receipt.done = position == 0;
+    }
 
-    if (svr_iterator == svrs_table.end()) {
-        // emplace
-        svrs_table.emplace(get_self(), [&](auto &svr) { ; });
-        svr_iterator = svrs_table.begin();
+    receipt.processed = cursor_iterator->processed + receipt.rows;
+
+    // the operation is complete, so the next one on this table starts afresh
+    if (receipt.done) {
+        ram_erased("cursors"_n, *cursor_iterator);
+        cursors_table.erase(cursor_iterator);
     } else {
-        svrs_table.modify(svr_iterator, get_self(), [&](auto &svr) {
-          svr.survey0 = 1;
-          svr.survey1 = 1;
-          svr.survey2 = 1;
-          svr.survey3 = 1;
-          svr.survey4 = 1;
-          svr.vote0 = 1;
-          svr.vote1 = 1;
-          svr.vote2 = 1;
-          svr.vote3 = 1;
-          svr.vote4 = 1;
-          svr.ratify0 = 0;
-          svr.ratify1 = 0;
-          svr.ratify2 = 0;
-          svr.ratify3 = 0;
-          svr.ratify4 = 0;
+        cursors_table.modify(cursor_iterator, get_self(), [&](auto &c) {
+            c.position = position;
+            c.processed = receipt.processed;
         });
     }
-    
-  }
-
-  if (action == "reset svrs") {
-    svr_index svr_table1(get_self(), name("alanappleton").value);
-    svr_index svr_table2(get_self(), name("billbeaumont").value);
-    svr_index svr_table3(get_self(), name("celiacollins").value);
-    svr_index svr_table4(get_self(), name("darlenedole").value);
-    svr_index svr_table5(get_self(), name("dennisedolan").value);
-
-    svr_index svr_table6(get_self(), name("ellaevery").value);
-    svr_index svr_table7(get_self(), name("ethanedwards").value);
-    svr_index svr_table8(get_self(), name("frankyfellon").value);
-    svr_index svr_table9(get_self(), name("freeosfreeos").value);
-    svr_index svr_table10(get_self(), name("veronicavale").value);
-
-    svr_index svr_table11(get_self(), name("verovera").value);
-    svr_index svr_table12(get_self(), name("victorvector").value);
-    svr_index svr_table13(get_self(), name("vivcoleman").value);
-    svr_index svr_table14(get_self(), name("vivvestin").value);
-    svr_index svr_table15(get_self(), name("vladvickens").value);
-
-    auto svr_iterator1 = svr_table1.begin();
-    auto svr_iterator2 = svr_table2.begin();
-    auto svr_iterator3 = svr_table3.begin();
-    auto svr_iterator4 = svr_table4.begin();
-    auto svr_iterator5 = svr_table5.begin();
-    
-    auto svr_iterator6 = svr_table6.begin();
-    auto svr_iterator7 = svr_table7.begin();
-    auto svr_iterator8 = svr_table8.begin();
-    auto svr_iterator9 = svr_table9.begin();
-    auto svr_iterator10 = svr_table10.begin();
-    
-    auto svr_iterator11 = svr_table11.begin();
-    auto svr_iterator12 = svr_table12.begin();
-    auto svr_iterator13 = svr_table13.begin();
-    auto svr_iterator14 = svr_table14.begin();
-    auto svr_iterator15 = svr_table15.begin();
-    
-    svr_table1.erase(svr_iterator1);
-    svr_table2.erase(svr_iterator2);
-    svr_table3.erase(svr_iterator3);
-    svr_table4.erase(svr_iterator4);
-    svr_table5.erase(svr_iterator5);
-
-    svr_table6.erase(svr_iterator6);
-    svr_table7.erase(svr_iterator7);
-    svr_table8.erase(svr_iterator8);
-    svr_table9.erase(svr_iterator9);
-    svr_table10.erase(svr_iterator10);
-
-    svr_table11.erase(svr_iterator11);
-    svr_table12.erase(svr_iterator12);
-    svr_table13.erase(svr_iterator13);
-    svr_table14.erase(svr_iterator14);
-    svr_table15.erase(svr_iterator15);
-    
-  }
-
-  if (action == "clear survey") {
-    survey_index survey_table(get_self(), get_self().value);
-    auto survey_iterator = survey_table.begin();
-    survey_table.erase(survey_iterator);
-  }
-
-  if (action == "current iteration") {
-    uint16_t iteration = 0;
-
-    // get the start of freeos system time
-    system_index system_table(get_self(), get_self().value);
-    auto system_iterator = system_table.begin();
-    check(system_iterator != system_table.end(), "system record is undefined");
-    time_point init = system_iterator->init;
-
-    // how far are we into the current iteration?
-    uint64_t now_secs = current_time_point().sec_since_epoch();
-    uint64_t init_secs = init.sec_since_epoch();
-
-    if (now_secs >= init_secs) {
-      iteration = ((now_secs - init_secs) / ITERATION_LENGTH_SECONDS) + 1;
-    }
-
-    string debug_msg = "now_secs = " + to_string(now_secs) + ", init_secs = " + to_string(init_secs) + ", ITERATION_LENGTH_SECONDS = " + to_string(ITERATION_LENGTH_SECONDS) + ", calculated iteration = " + to_string(iteration);
-    check(false, debug_msg);
-  }
 
-} */
\ No newline at end of file
+    return receipt;
+}
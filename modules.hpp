@@ -0,0 +1,123 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include "tables.hpp"
+
+// Module selection
+// Each optional governance module is compiled in or out with its MODULE_* define, e.g. -DMODULE_POLL=0. A disabled
+// module's source file is not included and its actions are not declared, and its hooks are discarded at compile time
+// by if constexpr - so it adds no WASM code and no runtime checks.
+//
+// The survey, ratify and points code is commented out in this version, so those files are not modules and cannot be
+// selected.
+
+#ifndef MODULE_DELEGATE
+#define MODULE_DELEGATE 1
+#endif
+
+#ifndef MODULE_POLL
+#define MODULE_POLL 1
+#endif
+
+#ifndef MODULE_CLAIM
+#define MODULE_CLAIM 1
+#endif
+
+#ifndef MODULE_LEADERBOARD
+#define MODULE_LEADERBOARD 1
+#endif
+
+#ifndef MODULE_IMPORT
+#define MODULE_IMPORT 1
+#endif
+
+#ifndef MODULE_MAINTAIN
+#define MODULE_MAINTAIN 1
+#endif
+
+namespace freedao {
+
+using eosio::name;
+
+// the hooks a module may provide - by default they do nothing
+// hooks take the contract as a template parameter, so a disabled module's hooks are never instantiated
+struct module_base {
+    template <typename C> static void init(C &contract) {}                              // from init
+    template <typename C> static void cron(C &contract) {}                              // from cron, after tick
+    template <typename C> static void rollover(C &contract, uint32_t old_iteration) {}  // at the end of an iteration
+    template <typename C> static void reset(C &contract) {}                             // ready for the new iteration
+    template <typename C> static void eligibility(C &contract, name user) {}            // checks before a user votes
+};
+
+// voting is the core of the contract, so it is always enabled
+struct vote_module : module_base {
+    static constexpr bool enabled = true;
+    template <typename C> static void init(C &contract) { contract.vote_init(); }
+    template <typename C> static void reset(C &contract) { contract.vote_reset(); }
+    template <typename C> static void eligibility(C &contract, name user) {
+        eosio::check(contract.is_staked(user), "voting is not open to unstaked users");
+    }
+};
+
+struct delegate_module : module_base {
+    static constexpr bool enabled = MODULE_DELEGATE;
+    // a user who has delegated their vote is represented by their proxy
+    template <typename C> static void eligibility(C &contract, name user) {
+        delegation_index delegation_table(contract.get_self(), user.value);
+        eosio::check(delegation_table.begin() == delegation_table.end(), "user has delegated their vote to a proxy");
+    }
+};
+
+struct poll_module : module_base {
+    static constexpr bool enabled = MODULE_POLL;
+    // close any polls that have reached their closing time
+    template <typename C> static void cron(C &contract) { contract.poll_finalise(); }
+};
+
+struct leaderboard_module : module_base {
+    static constexpr bool enabled = MODULE_LEADERBOARD;
+    // keep a record of the leaderboard at the end of the iteration
+    template <typename C> static void rollover(C &contract, uint32_t old_iteration) {
+        contract.leaderboard_snapshot(old_iteration);
+    }
+};
+
+// run a hook on each enabled module, in the order listed
+template <typename... Modules>
+struct module_list {
+    template <typename C> static void init(C &contract) {
+        (init_one<Modules>(contract), ...);
+    }
+    template <typename C> static void cron(C &contract) {
+        (cron_one<Modules>(contract), ...);
+    }
+    template <typename C> static void rollover(C &contract, uint32_t old_iteration) {
+        (rollover_one<Modules>(contract, old_iteration), ...);
+    }
+    template <typename C> static void reset(C &contract) {
+        (reset_one<Modules>(contract), ...);
+    }
+    template <typename C> static void eligibility(C &contract, name user) {
+        (eligibility_one<Modules>(contract, user), ...);
+    }
+
+private:
+    template <typename M, typename C> static void init_one(C &contract) {
+        if constexpr (M::enabled) M::init(contract);
+    }
+    template <typename M, typename C> static void cron_one(C &contract) {
+        if constexpr (M::enabled) M::cron(contract);
+    }
+    template <typename M, typename C> static void rollover_one(C &contract, uint32_t old_iteration) {
+        if constexpr (M::enabled) M::rollover(contract, old_iteration);
+    }
+    template <typename M, typename C> static void reset_one(C &contract) {
+        if constexpr (M::enabled) M::reset(contract);
+    }
+    template <typename M, typename C> static void eligibility_one(C &contract, name user) {
+        if constexpr (M::enabled) M::eligibility(contract, user);
+    }
+};
+
+using modules = module_list<vote_module, delegate_module, poll_module, leaderboard_module>;
+
+} // namespace freedao
@@ -0,0 +1,131 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+#include <cmath>
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Price oracle
+// Observations are kept in a fixed-size ring buffer. Each slot records a price and the number of seconds it was in
+// force, and the twap row keeps the running sums, so adding an observation and reading the average are both O(1).
+
+// ACTION
+void freeosgov::priceupdate(double price) {
+
+    // check if the price account is calling this action, or the contract itself
+    string price_account = get_parameter_or(name("priceacct"), string());
+    if (!price_account.empty()) {
+        require_auth(name(price_account));
+    } else {
+        require_auth(get_self());
+    }
+
+    check(std::isfinite(price) && price > 0.0, "price must be positive");
+    check_lazy(price <= PRICE_CEILING, [&] { return "price must not exceed " + to_string(PRICE_CEILING); });
+
+    uint64_t scaled_price = (uint64_t) (price * VOTE_SCALE + 0.5);
+    time_point_sec now = current_time_point();
+
+    twap_index twap_table(get_self(), get_self().value);
+    auto twap_iterator = twap_table.begin();
+
+    // the first observation - nothing to average yet
+    if (twap_iterator == twap_table.end()) {
+        // get the window size
+        uint32_t size = get_parameter_or(name("twapsize"), TWAP_SLOTS);
+        check(size > 0, "twap window must have at least one slot");
+
+        twap_iterator = twap_table.emplace(get_self(), [&](auto &t) {
+            t.size = size;
+            t.head = 0;
+            t.last_price = scaled_price;
+            t.last_time = now;
+            t.weighted = 0;
+            t.duration = 0;
+            t.updates = {0, 0};
+            t.updates.add(system_record().iteration);
+        });
+        ram_emplaced("twap"_n, *twap_iterator);
+        return;
+    }
+
+    uint32_t elapsed = now.sec_since_epoch() - twap_iterator->last_time.sec_since_epoch();
+
+    // a second observation in the same second replaces the first
+    if (elapsed == 0) {
+        twap_table.modify(twap_iterator, get_self(), [&](auto &t) {
+            t.last_price = scaled_price;
+            t.updates.add(system_record().iteration);
+        });
+        return;
+    }
+
+    // the previous price was in force until now, so it enters the window - overwriting the oldest slot when full
+    priceobs_index priceobs_table(get_self(), get_self().value);
+    auto obs_iterator = priceobs_table.find(twap_iterator->head);
+
+    uint128_t weighted = twap_iterator->weighted + (uint128_t) twap_iterator->last_price * elapsed;
+    uint64_t duration = twap_iterator->duration + elapsed;
+
+    if (obs_iterator == priceobs_table.end()) {
+        obs_iterator = priceobs_table.emplace(get_self(), [&](auto &o) {
+            o.slot = twap_iterator->head;
+            o.price = twap_iterator->last_price;
+            o.duration = elapsed;
+        });
+        ram_emplaced("priceobs"_n, *obs_iterator);
+    } else {
+        weighted -= (uint128_t) obs_iterator->price * obs_iterator->duration;
+        duration -= obs_iterator->duration;
+
+        priceobs_table.modify(obs_iterator, get_self(), [&](auto &o) {
+            o.price = twap_iterator->last_price;
+            o.duration = elapsed;
+        });
+    }
+
+    twap_table.modify(twap_iterator, get_self(), [&](auto &t) {
+        t.head = (t.head + 1) % t.size;
+        t.last_price = scaled_price;
+        t.last_time = now;
+        t.weighted = weighted;
+        t.duration = duration;
+        t.updates.add(system_record().iteration);
+    });
+}
+
+// the time-weighted average price over the window up to now, or 0.0 if there are no observations or the latest one
+// is too old - the caller then uses the spot price
+double freeosgov::price_twap() {
+    twap_index twap_table(get_self(), get_self().value);
+    auto twap_iterator = twap_table.begin();
+
+    if (twap_iterator == twap_table.end()) {
+        return 0.0;
+    }
+
+    // get the maximum age
+    uint32_t max_age = get_parameter_or(name("twapmaxage"), TWAP_MAX_AGE);
+
+    uint32_t age = current_time_point().sec_since_epoch() - twap_iterator->last_time.sec_since_epoch();
+    if (age > max_age) {
+        return 0.0;
+    }
+
+    // the latest price has been in force since it was observed
+    uint128_t weighted = twap_iterator->weighted + (uint128_t) twap_iterator->last_price * age;
+    uint64_t duration = twap_iterator->duration + age;
+
+    // only one observation so far, made in this second
+    if (duration == 0) {
+        return (double) twap_iterator->last_price / VOTE_SCALE;
+    }
+
+    return (double) (weighted / duration) / VOTE_SCALE;
+}
@@ -196,14 +196,14 @@ void freeosgov::mintfreeby(const name &owner, const asset &quantity) {
 
   // ask FREEBY contract to issue an equivalent amount of FREEBY tokens to the freeosgov account
   action issue_action = action(
-      permission_level{get_self(), "active"_n}, name(freeby_acct),
+      permission_level{get_self(), "active"_n}, FREEBY_ACCT,
       "issue"_n, std::make_tuple(get_self(), exchangeable_amount, memo));
 
   issue_action.send();
 
   // transfer FREEBY tokens to the owner
   action transfer_action = action(
-      permission_level{get_self(), "active"_n}, name(freeby_acct),
+      permission_level{get_self(), "active"_n}, FREEBY_ACCT,
       "transfer"_n,
       std::make_tuple(get_self(), owner, exchangeable_amount, memo));
 
@@ -223,7 +223,7 @@ void freeosgov::mintfreeos(const name &owner, const asset &quantity) {
   if (sym == POINT_CURRENCY_SYMBOL) {
     token_contract = name(get_self());
   } else {
-    token_contract = name(freeby_acct);
+    token_contract = FREEBY_ACCT;
   }
 
   stats statstable(token_contract, sym.code().raw());
@@ -247,14 +247,14 @@ void freeosgov::mintfreeos(const name &owner, const asset &quantity) {
 
   // ask FREEOS contract to issue an equivalent amount of FREEOS tokens to the freeosgov account
   action issue_action = action(
-      permission_level{get_self(), "active"_n}, name(freeos_acct),
+      permission_level{get_self(), "active"_n}, FREEOS_ACCT,
       "issue"_n, std::make_tuple(get_self(), exchangeable_amount, memo));
 
   issue_action.send();
 
   // transfer FREEOS tokens to the owner
   action transfer_action = action(
-      permission_level{get_self(), "active"_n}, name(freeos_acct),
+      permission_level{get_self(), "active"_n}, FREEOS_ACCT,
       "transfer"_n,
       std::make_tuple(get_self(), owner, exchangeable_amount, memo));
 
@@ -0,0 +1,145 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// ACTION
+uint64_t freeosgov::propose(string question, uint8_t type, double minimum, double maximum, uint8_t choices, time_point opens, time_point closes) {
+
+    require_auth(get_self());
+
+    check(!question.empty() && question.size() <= 256, "question must be between 1 and 256 characters");
+    check(type == POLL_AVERAGE || type == POLL_CHOICE, "invalid poll type");
+    check(closes > opens, "poll must close after it opens");
+    check(closes > current_time_point(), "poll closing time is in the past");
+
+    if (type == POLL_AVERAGE) {
+        check(minimum >= 0.0 && maximum > minimum, "invalid response range");
+    } else {
+        check(choices >= 2 && choices <= POLL_MAX_CHOICES, "invalid number of choices");
+    }
+
+    proposals_index proposals_table(get_self(), get_self().value);
+    auto proposal_iterator = proposals_table.emplace(get_self(), [&](auto &p) {
+        p.id = proposals_table.available_primary_key();
+        p.question = question;
+        p.type = type;
+        p.minimum = minimum;
+        p.maximum = maximum;
+        p.choices = type == POLL_CHOICE ? choices : 0;
+        p.opens = opens;
+        p.closes = closes;
+        p.status = POLL_OPEN;
+        p.participants = 0;
+        p.sum = 0;
+        p.tally.resize(p.choices, 0);
+        p.result = 0.0;
+    });
+    ram_emplaced("proposals"_n, *proposal_iterator);
+
+    // the new poll's id
+    return proposal_iterator->id;
+}
+
+// ACTION
+void freeosgov::pollvote(name user, uint64_t id, double response) {
+
+    require_auth(user);
+
+    rollover_check();
+
+    // is the user staked?
+    check(is_staked(user), "voting is not open to unstaked users");
+
+    proposals_index proposals_table(get_self(), get_self().value);
+    auto proposal_iterator = proposals_table.find(id);
+    check(proposal_iterator != proposals_table.end(), "poll does not exist");
+
+    // is the poll open?
+    time_point now = current_time_point();
+    check(proposal_iterator->status == POLL_OPEN && now >= proposal_iterator->opens && now < proposal_iterator->closes,
+        "poll is not open");
+
+    // has the user already voted in this poll?
+    pollvotes_index pollvotes_table(get_self(), id);
+    check(pollvotes_table.find(user.value) == pollvotes_table.end(), "user has already voted in this poll");
+
+    // argument validation
+    uint8_t choice = 0;
+    if (proposal_iterator->type == POLL_AVERAGE) {
+        check(response >= proposal_iterator->minimum && response <= proposal_iterator->maximum, "response is out of range");
+    } else {
+        // range-check before converting - a NaN fails the comparison
+        check(response >= 1 && response <= proposal_iterator->choices, "choice is out of range");
+        choice = (uint8_t) response;
+        check(choice == response, "choice must be a whole number");
+    }
+
+    // only this poll's aggregate is touched, however many polls are open
+    proposals_table.modify(proposal_iterator, get_self(), [&](auto &p) {
+        if (p.type == POLL_AVERAGE) {
+            p.sum += (uint64_t) (response * VOTE_SCALE + 0.5);
+        } else {
+            p.tally[choice - 1] += 1;
+        }
+        p.participants += 1;
+    });
+
+    auto pollvote_iterator = pollvotes_table.emplace(get_self(), [&](auto &v) {
+        v.user = user;
+        v.response = response;
+    });
+    ram_emplaced("pollvotes"_n, *pollvote_iterator);
+}
+
+// close expired polls, a bounded number per call
+void freeosgov::poll_finalise() {
+
+    // get the batch size
+    uint32_t batch = get_parameter_or(name("pollbatch"), POLL_BATCH);
+
+#ifdef CONFIG_GOVRESULTS
+    // polls are held to the same quorum as the locking threshold
+    uint32_t poll_quorum = stoi(get_parameter(name("lockquorum")));
+#endif
+
+    uint64_t now = current_time_point().time_since_epoch()._count;
+
+    proposals_index proposals_table(get_self(), get_self().value);
+    auto closes_index = proposals_table.get_index<"closes"_n>();
+
+    for (uint32_t finalised = 0; finalised < batch; finalised++) {
+        // the front of the index is the open poll with the earliest closing time
+        auto proposal_iterator = closes_index.begin();
+        if (proposal_iterator == closes_index.end() || proposal_iterator->get_closes() > now) break;
+
+        closes_index.modify(proposal_iterator, get_self(), [&](auto &p) {
+            p.status = POLL_CLOSED;
+
+            if (p.type == POLL_AVERAGE) {
+                p.result = p.participants > 0 ? (double) p.sum / p.participants / VOTE_SCALE : 0.0;
+            } else {
+                uint32_t winning_votes = 0;
+                for (size_t i = 0; i < p.tally.size(); i++) {
+                    if (p.tally[i] > winning_votes) {
+                        winning_votes = p.tally[i];
+                        p.result = i + 1;
+                    }
+                }
+            }
+        });
+
+#ifdef CONFIG_GOVRESULTS
+        // the outcome goes to the configuration contract at the next rollover
+        result_pending(gov_outcome{"poll"_n, proposal_iterator->id, proposal_iterator->result,
+                                   proposal_iterator->participants,
+                                   proposal_iterator->participants >= poll_quorum});
+#endif
+    }
+}
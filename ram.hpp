@@ -0,0 +1,136 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// RAM accounting
+// Row counts and approximate bytes are kept per table and updated alongside each emplace and erase. The changes are
+// added up in the action context and each table's ramstats row is written once, at the end of the action.
+// Bytes are the packed row size plus RAM_ROW_OVERHEAD, which approximates what the chain bills per row.
+//
+// Rows written before accounting began are not counted, so erasing them would take the counts below zero. Until a
+// table's counts have been seeded with ramseed, from a count of its rows taken off chain, only its growth is counted.
+
+template <typename T>
+void freeosgov::ram_emplaced(name table, const T &row) {
+    ram_track(table, 1, pack_size(row) + RAM_ROW_OVERHEAD);
+}
+
+template <typename T>
+void freeosgov::ram_erased(name table, const T &row) {
+    ram_track(table, -1, -(int64_t) (pack_size(row) + RAM_ROW_OVERHEAD));
+}
+
+// a modify that changes the packed size of a row
+void freeosgov::ram_resized(name table, int64_t bytes) {
+    if (bytes != 0) ram_track(table, 0, bytes);
+}
+
+void freeosgov::ram_track(name table, int64_t rows, int64_t bytes) {
+    auto &delta = context.ram[table.value];
+    delta.first += rows;
+    delta.second += bytes;
+}
+
+// write the changes of the action so far to the ramstats table - one write per table
+void freeosgov::ram_flush() {
+    ramstats_index ramstats_table(get_self(), get_self().value);
+
+    for (const auto &[table, delta] : context.ram) {
+        if (delta.first == 0 && delta.second == 0) continue;
+
+        auto ramstat_iterator = ramstats_table.find(table);
+        if (ramstat_iterator == ramstats_table.end()) {
+            ramstats_table.emplace(get_self(), [&](auto &r) {
+                r.table = name(table);
+                r.rows = std::max<int64_t>(delta.first, 0);
+                r.bytes = std::max<int64_t>(delta.second, 0);
+                r.seeded = false;
+            });
+        } else {
+            ramstats_table.modify(ramstat_iterator, get_self(), [&](auto &r) {
+                r.rows += delta.first;
+                r.bytes += delta.second;
+
+                // an unseeded table may be erasing rows it never counted
+                if (!r.seeded) {
+                    r.rows = std::max<int64_t>(r.rows, 0);
+                    r.bytes = std::max<int64_t>(r.bytes, 0);
+                }
+            });
+        }
+    }
+
+    context.ram.clear();
+}
+
+// at the end of an iteration, record how much each table grew
+void freeosgov::ram_rollover() {
+    ram_flush();
+
+    ramstats_index ramstats_table(get_self(), get_self().value);
+
+    for (auto ramstat_iterator = ramstats_table.begin(); ramstat_iterator != ramstats_table.end(); ramstat_iterator++) {
+        ramstats_table.modify(ramstat_iterator, get_self(), [&](auto &r) {
+            r.growth_rows = r.rows - r.start_rows;
+            r.growth_bytes = r.bytes - r.start_bytes;
+            r.start_rows = r.rows;
+            r.start_bytes = r.bytes;
+        });
+    }
+}
+
+// ACTION
+// set a table's counts from a count of its rows, across all scopes, taken off chain
+void freeosgov::ramseed(name table, int64_t rows, int64_t bytes) {
+
+    require_auth(get_self());
+
+    check(rows >= 0 && bytes >= 0, "counts must not be negative");
+
+    // changes made earlier in the action are already in the off-chain count
+    context.ram.erase(table.value);
+
+    ramstats_index ramstats_table(get_self(), get_self().value);
+    auto ramstat_iterator = ramstats_table.find(table.value);
+
+    if (ramstat_iterator == ramstats_table.end()) {
+        ramstats_table.emplace(get_self(), [&](auto &r) {
+            r.table = table;
+            r.rows = rows;
+            r.bytes = bytes;
+            r.start_rows = rows;
+            r.start_bytes = bytes;
+            r.seeded = true;
+        });
+    } else {
+        ramstats_table.modify(ramstat_iterator, get_self(), [&](auto &r) {
+            r.rows = rows;
+            r.bytes = bytes;
+            r.start_rows = rows;
+            r.start_bytes = bytes;
+            r.seeded = true;
+        });
+    }
+}
+
+// ACTION
+// read-only - returns the RAM statistics for every table
+std::vector<ram_stat> freeosgov::ramreport() {
+    std::vector<ram_stat> report;
+
+    ramstats_index ramstats_table(get_self(), get_self().value);
+    for (auto ramstat_iterator = ramstats_table.begin(); ramstat_iterator != ramstats_table.end(); ramstat_iterator++) {
+        report.push_back(*ramstat_iterator);
+    }
+
+    return report;
+}
@@ -38,7 +38,7 @@ void freeosgov::ratify(name user, bool ratify_vote) {
     
     require_auth(user);
 
-    tick();
+    iteration_update();
 
     // is the user registered?
     check(is_registered(user), "ratify is not open to unregistered users");
@@ -0,0 +1,78 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Governance results
+// When built with -DCONFIG_GOVRESULTS, for a configuration contract that has the govresults action, outcomes finalised
+// during an iteration are held in the pendresults row and sent at rollover together with the locking threshold in a
+// single govresults action - one cross-contract call per iteration however many questions are governed. Each outcome
+// carries its own quorum flag, and only outcomes that reached quorum carry a result.
+//
+// Otherwise only the locking threshold is sent, in a targetrate action when it reaches quorum, as before, and poll
+// outcomes are not held.
+
+#ifdef CONFIG_GOVRESULTS
+// hold an outcome until the next rollover
+void freeosgov::result_pending(const gov_outcome &outcome) {
+    pendresults_index pendresults_table(get_self(), get_self().value);
+    auto pending_iterator = pendresults_table.begin();
+
+    if (pending_iterator == pendresults_table.end()) {
+        pending_iterator = pendresults_table.emplace(get_self(), [&](auto &p) {
+            p.outcomes.push_back(outcome);
+        });
+        ram_emplaced("pendresults"_n, *pending_iterator);
+    } else {
+        int64_t old_size = pack_size(*pending_iterator);
+        pendresults_table.modify(pending_iterator, get_self(), [&](auto &p) {
+            p.outcomes.push_back(outcome);
+        });
+        ram_resized("pendresults"_n, pack_size(*pending_iterator) - old_size);
+    }
+}
+#endif
+
+// send the iteration's outcomes to the configuration contract
+void freeosgov::results_send(uint32_t iteration, const gov_outcome &outcome) {
+#ifdef CONFIG_GOVRESULTS
+    // the outcomes are only held until they are sent, so they are built in the action arena
+    arena_vector<gov_outcome> outcomes = {outcome};
+
+    pendresults_index pendresults_table(get_self(), get_self().value);
+    auto pending_iterator = pendresults_table.begin();
+
+    if (pending_iterator != pendresults_table.end()) {
+        outcomes.insert(outcomes.end(), pending_iterator->outcomes.begin(), pending_iterator->outcomes.end());
+
+        ram_erased("pendresults"_n, *pending_iterator);
+        pendresults_table.erase(pending_iterator);
+    }
+
+    // an outcome that did not reach quorum is reported without its result
+    for (auto &o : outcomes) {
+        if (!o.quorum) o.result = 0.0;
+    }
+
+    action(
+        permission_level{get_self(), "active"_n}, FREEOSCONFIG_ACCT,
+        "govresults"_n,
+        std::make_tuple(iteration, outcomes))
+        .send();
+#else
+    if (outcome.quorum) {
+        // write the locking threshold back to the exchangerate table on freeoscfg
+        action(
+            permission_level{get_self(), "active"_n}, FREEOSCONFIG_ACCT,
+            "targetrate"_n,
+            std::make_tuple(outcome.result))
+            .send();
+    }
+#endif
+}
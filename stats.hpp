@@ -0,0 +1,69 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// Statistics
+// The counters of the iteration in progress are kept in rows that are written anyway - ballots in the vote record,
+// cron calls on the sweep cursor (written by every cron once the retention period has passed), price updates on the
+// twap row and imports on the airimport cursor - and archived to the stats table at rollover. Each action counter
+// holds the iteration it counts, so one made before the rollover is archived with the iteration it belongs to.
+
+// the counters of an iteration, read from the rows that hold them
+iteration_stats freeosgov::stats_collect(uint32_t iteration) {
+    const vote_record &votes = voting_record();
+    iteration_stats stats{iteration, votes.participants, votes.amendment_count(), votes.total_weight(), 0, 0, 0};
+
+    cursors_index cursors_table(get_self(), get_self().value);
+    auto cursor_iterator = cursors_table.find(name("sweep").value);
+    if (cursor_iterator != cursors_table.end()) stats.crons = cursor_iterator->calls.in(iteration);
+
+    cursor_iterator = cursors_table.find(name("airimport").value);
+    if (cursor_iterator != cursors_table.end()) stats.imports = cursor_iterator->calls.in(iteration);
+
+    twap_index twap_table(get_self(), get_self().value);
+    auto twap_iterator = twap_table.begin();
+    if (twap_iterator != twap_table.end()) stats.price_updates = twap_iterator->updates.in(iteration);
+
+    return stats;
+}
+
+// archive the counters of the iteration that has just ended - called before the vote record is reset
+void freeosgov::stats_archive(uint32_t iteration) {
+    // iteration 0 is before the contract opened, so there is nothing to archive
+    if (iteration == 0) return;
+
+    iteration_stats stats = stats_collect(iteration);
+
+    stats_index stats_table(get_self(), get_self().value);
+    auto stats_iterator = stats_table.find(iteration);
+    if (stats_iterator == stats_table.end()) {
+        stats_iterator = stats_table.emplace(get_self(), [&](auto &s) { s = stats; });
+        ram_emplaced("stats"_n, *stats_iterator);
+    } else {
+        stats_table.modify(stats_iterator, get_self(), [&](auto &s) { s = stats; });
+    }
+}
+
+// ACTION
+// the counters of an iteration - the current one is read from the live records
+iteration_stats freeosgov::statsreport(uint32_t iteration) {
+
+    const auto &system_row = system_record();
+
+    if (iteration == 0 || iteration == system_row.iteration) {
+        return stats_collect(system_row.iteration);
+    }
+
+    stats_index stats_table(get_self(), get_self().value);
+    auto stats_iterator = stats_table.find(iteration);
+    check(stats_iterator != stats_table.end(), "there are no statistics for the iteration");
+
+    return *stats_iterator;
+}
@@ -9,21 +9,6 @@ using namespace freedao;
 using namespace std;
 
 
-vector<string> split (string s, string delimiter) {
-    size_t pos_start = 0, pos_end, delim_len = delimiter.length();
-    string token;
-    vector<string> res;
-
-    while ((pos_end = s.find (delimiter, pos_start)) != string::npos) {
-        token = s.substr (pos_start, pos_end - pos_start);
-        pos_start = pos_end + delim_len;
-        res.push_back (token);
-    }
-
-    res.push_back (s.substr (pos_start));
-    return res;
-}
-
 /*
 std::vector<int> parse_survey_ranges(string surveyranges) {
     
@@ -90,7 +75,7 @@ void freeosgov::survey(name user, uint8_t q1response, uint8_t q2response, uint8_
     
     require_auth(user);
 
-    tick();
+    iteration_update();
 
     // is the user registered?
     check(is_registered(user), "survey is not open to unregistered users");
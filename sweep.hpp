@@ -0,0 +1,141 @@
+//#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "votemvp.hpp"
+#include "tables.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+
+using namespace eosio;
+using namespace freedao;
+using namespace std;
+
+// record the latest iteration in which the user took part
+void freeosgov::record_activity(name user, uint32_t iteration) {
+    actives_index actives_table(get_self(), get_self().value);
+    auto active_iterator = actives_table.find(user.value);
+
+    if (active_iterator == actives_table.end()) {
+        active_iterator = actives_table.emplace(get_self(), [&](auto &a) {
+            a.user = user;
+            a.last_active = iteration;
+        });
+        ram_emplaced("actives"_n, *active_iterator);
+    } else if (active_iterator->last_active != iteration) {
+        actives_table.modify(active_iterator, get_self(), [&](auto &a) {
+            a.last_active = iteration;
+        });
+    }
+}
+
+// ACTION
+// add users whose participation records predate the actives table, so that the sweep can find them - the users are
+// listed off chain from the scopes of the svrs table
+uint32_t freeosgov::seedactives(vector<name> users) {
+
+    require_auth(get_self());
+
+    uint32_t budget = get_parameter_or(name("sweepbudget"), SWEEP_BUDGET);
+    check_lazy(!users.empty() && users.size() <= budget, [&] { return "number of users must be between 1 and " + to_string(budget); });
+
+    actives_index actives_table(get_self(), get_self().value);
+    uint32_t seeded = 0;
+
+    for (name user : users) {
+        if (actives_table.find(user.value) != actives_table.end()) continue;
+
+        svr_index svrs_table(get_self(), user.value);
+        auto svr_iterator = svrs_table.begin();
+        if (svr_iterator == svrs_table.end()) continue;
+
+        // the latest iteration recorded in the user's participation record
+        uint32_t last_active = std::max({svr_iterator->survey0, svr_iterator->survey1, svr_iterator->survey2,
+                                         svr_iterator->survey3, svr_iterator->survey4, svr_iterator->vote0,
+                                         svr_iterator->vote1, svr_iterator->vote2, svr_iterator->vote3,
+                                         svr_iterator->vote4, svr_iterator->ratify0, svr_iterator->ratify1,
+                                         svr_iterator->ratify2, svr_iterator->ratify3, svr_iterator->ratify4});
+        record_activity(user, last_active);
+        seeded++;
+    }
+
+    return seeded;
+}
+
+// erase the participation records of users who have been inactive for longer than the retention period
+// walks the actives table from a stored cursor, examining at most 'budget' users per call - run by cron
+void freeosgov::sweep(uint32_t budget) {
+
+    uint32_t this_iteration = system_record().iteration;
+
+    // get the retention period
+    uint32_t retention = get_parameter_or(name("retention"), RETENTION_ITERATIONS);
+
+    // nobody can have expired yet
+    if (this_iteration <= retention) return;
+    uint32_t expiry_iteration = this_iteration - retention;
+
+    // resume from the cursor
+    cursors_index cursors_table(get_self(), get_self().value);
+    auto cursor_iterator = cursors_table.find(name("sweep").value);
+    if (cursor_iterator == cursors_table.end()) {
+        cursor_iterator = cursors_table.emplace(get_self(), [&](auto &c) {
+            c.job = name("sweep");
+            c.position = 0;
+            c.processed = 0;
+            c.calls = {0, 0};
+        });
+        ram_emplaced("cursors"_n, *cursor_iterator);
+    }
+
+    actives_index actives_table(get_self(), get_self().value);
+    auto active_iterator = actives_table.lower_bound(cursor_iterator->position);
+    uint32_t erased = 0;
+
+    for (uint32_t examined = 0; examined < budget && active_iterator != actives_table.end(); examined++) {
+        if (active_iterator->last_active >= expiry_iteration) {
+            active_iterator++;
+            continue;
+        }
+
+        name user = active_iterator->user;
+
+        svr_index svrs_table(get_self(), user.value);
+        auto svr_iterator = svrs_table.begin();
+        if (svr_iterator != svrs_table.end()) {
+            ram_erased("svrs"_n, *svr_iterator);
+            svrs_table.erase(svr_iterator);
+        }
+
+        ballot_index ballots_table(get_self(), user.value);
+        auto ballot_iterator = ballots_table.begin();
+        if (ballot_iterator != ballots_table.end()) {
+            ram_erased("ballots"_n, *ballot_iterator);
+            ballots_table.erase(ballot_iterator);
+        }
+
+        tally_index tally_table(get_self(), user.value);
+        auto tally_iterator = tally_table.begin();
+        if (tally_iterator != tally_table.end()) {
+            ram_erased("tallies"_n, *tally_iterator);
+            tally_table.erase(tally_iterator);
+        }
+
+        // the leaderboard entry goes with the tally
+        if constexpr (leaderboard_module::enabled) {
+            leaderboard_remove(user);
+        }
+
+        ram_erased("actives"_n, *active_iterator);
+        active_iterator = actives_table.erase(active_iterator);
+        erased++;
+    }
+
+    // save the cursor - wrapping round to the start when the end of the table is reached
+    uint64_t position = active_iterator == actives_table.end() ? 0 : active_iterator->user.value;
+    cursors_table.modify(cursor_iterator, get_self(), [&](auto &c) {
+        c.position = position;
+        c.processed += erased;
+        c.calls.add(this_iteration);
+    });
+}
@@ -1,12 +1,99 @@
 #pragma once
 #include <eosio/eosio.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/singleton.hpp>
 #include "eosio.proton.hpp"
+#include "constants.hpp"
 
 using namespace eosio;
 using namespace std;
 
 namespace freedao {
 
+// STORAGE
+// Single-row tables are declared as row_store, which selects the storage backend at compile time - eosio::multi_index
+// by default, or eosio::singleton when built with -DSTORAGE_SINGLETON. The singleton backend presents the part of the
+// multi_index interface that single-row tables use (begin, end, emplace, modify and erase), so the code that reads
+// and writes these tables is the same for both. The backends keep the row under different primary keys, so switching
+// an existing deployment from one to the other needs its rows migrating.
+#ifdef STORAGE_SINGLETON
+
+template <eosio::name::raw TableName, typename T>
+class singleton_store {
+public:
+    // points at the cached row, or nothing for end()
+    class const_iterator {
+    public:
+        const_iterator(const T *row = nullptr) : row(row) {}
+        const T &operator*() const { return *row; }
+        const T *operator->() const { return row; }
+        bool operator==(const const_iterator &other) const { return row == other.row; }
+        bool operator!=(const const_iterator &other) const { return row != other.row; }
+
+    private:
+        const T *row;
+    };
+
+    singleton_store(name code, uint64_t scope) : table(code, scope) {}
+
+    const_iterator begin() const {
+        load();
+        return present ? const_iterator(&row) : end();
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    template <typename Lambda>
+    const_iterator emplace(name payer, Lambda &&constructor) {
+        load();
+        check(!present, "cannot emplace a second row in a single-row table");
+        row = T{};
+        constructor(row);
+        table.set(row, payer);
+        present = true;
+        return const_iterator(&row);
+    }
+
+    template <typename Lambda>
+    void modify(const const_iterator &iterator, name payer, Lambda &&updater) {
+        check(iterator != end(), "cannot pass end iterator to modify");
+        updater(row);
+        table.set(row, payer);
+    }
+
+    const_iterator erase(const const_iterator &iterator) {
+        check(iterator != end(), "cannot pass end iterator to erase");
+        table.remove();
+        present = false;
+        return end();
+    }
+
+private:
+    mutable eosio::singleton<TableName, T> table;
+    mutable T row;
+    mutable bool loaded = false;
+    mutable bool present = false;
+
+    // read the row at most once
+    void load() const {
+        if (loaded) return;
+        present = table.exists();
+        if (present) row = table.get();
+        loaded = true;
+    }
+};
+
+template <eosio::name::raw TableName, typename T>
+using row_store = singleton_store<TableName, T>;
+
+#else
+
+template <eosio::name::raw TableName, typename T>
+using row_store = eosio::multi_index<TableName, T>;
+
+#endif
+
+
 // SYSTEM
 // system table
 struct[[ eosio::table("system"), eosio::contract("votemvp") ]] system {
@@ -19,7 +106,7 @@ asset cls;
 
 uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
 };
-using system_index = eosio::multi_index<"system"_n, system>;
+using system_index = row_store<"system"_n, system>;
 
 
 // POINTS ACCOUNTS
@@ -123,6 +210,16 @@ uint64_t primary_key() const { return paramname.value; }
 };
 using dparameters_index = eosio::multi_index<"dparameters"_n, dparameter>;
 
+// PARAMETER CHANGE
+// one entry in a parambatch action
+struct param_change {
+  name paramname;
+  name op;        // upsert or erase
+  bool isdouble;  // true for the dparameters table
+  string value;   // new value of a string parameter
+  double dvalue;  // new value of a double parameter
+};
+
 
 // USERS
 // the registered user table
@@ -205,7 +302,7 @@ struct[[ eosio::table("svrs"), eosio::contract("votemvp") ]] svr {
 
     uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
 };
-using svr_index = eosio::multi_index<"svrs"_n, svr>;
+using svr_index = row_store<"svrs"_n, svr>;
 
 
 // VOTE
@@ -225,10 +322,332 @@ struct[[ eosio::table("voterecord"), eosio::contract("votemvp") ]] vote_record {
     uint32_t q6choice4; // partner 4
     uint32_t q6choice5; // partner 5
     uint32_t q6choice6; // partner 6
+    // fields added after the table was deployed are binary extensions, so rows written before the upgrade still unpack
+    binary_extension<uint32_t> weight;  // total vote weight, including votes delegated to proxies
+    binary_extension<uint64_t> q3sum;   // exact weighted sum of q3 responses, in units of 1/VOTE_SCALE
+    binary_extension<uint32_t> amendments;  // votes that replaced an earlier vote in the iteration
+
+    // every vote before the upgrade had a weight of 1
+    uint32_t total_weight() const { return weight.has_value() ? weight.value() : participants; }
+    uint64_t q3_sum() const {
+        return q3sum.has_value() ? q3sum.value() : (uint64_t) (q3average * total_weight() * VOTE_SCALE + 0.5);
+    }
+    uint32_t amendment_count() const { return amendments.has_value() ? amendments.value() : 0; }
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using vote_index = row_store<"voterecord"_n, vote_record>;
+
+
+// BALLOTS
+// the user's current vote - kept so that it can be amended within the iteration
+struct[[ eosio::table("ballots"), eosio::contract("votemvp") ]] ballot {
+    uint32_t iteration;
+    uint32_t weight;        // vote weight applied, including delegated votes
+    uint64_t q3response;    // locking threshold, in units of 1/VOTE_SCALE
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using ballot_index = row_store<"ballots"_n, ballot>;
+
+
+// DELEGATIONS
+// the proxy to whom a user has delegated their vote
+struct[[ eosio::table("delegations"), eosio::contract("votemvp") ]] delegation {
+    name proxy;
+    uint32_t delegated_iteration;
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using delegation_index = row_store<"delegations"_n, delegation>;
+
+
+// PROXIES
+// running total of the votes delegated to each proxy - maintained on delegate/undelegate
+struct[[ eosio::table("proxies"), eosio::contract("votemvp") ]] proxy {
+    name account;
+    uint32_t delegators;    // number of users who have delegated their vote to this proxy
+    uint32_t delegations;   // delegations made to this proxy - those withdrawn are delegations - delegators
+
+    uint64_t primary_key() const { return account.value; }
+};
+using proxies_index = eosio::multi_index<"proxies"_n, proxy>;
+
+
+// CLAIMROOTS
+// Merkle root of each iteration's reward list, computed off chain and published by the contract
+struct[[ eosio::table("claimroots"), eosio::contract("votemvp") ]] claim_root {
+    uint32_t iteration;
+    checksum256 root;
+    uint32_t leaves;    // number of entries in the reward list
+    asset total;        // sum of all rewards in the list
+    asset claimed;      // sum of rewards claimed so far
+    uint32_t claims;    // entries claimed so far
+
+    uint64_t primary_key() const { return iteration; }
+};
+using claimroots_index = eosio::multi_index<"claimroots"_n, claim_root>;
+
+// CLAIMBITS
+// bitmap of claimed reward list entries, 64 entries per row - scoped by iteration
+struct[[ eosio::table("claimbits"), eosio::contract("votemvp") ]] claim_bits {
+    uint64_t word;      // entry index / 64
+    uint64_t bits;      // bit (entry index % 64) is set when that entry has been claimed
+
+    uint64_t primary_key() const { return word; }
+};
+using claimbits_index = eosio::multi_index<"claimbits"_n, claim_bits>;
+
+
+// TALLIES
+// lifetime participation of a user - used to rank the user on the leaderboard
+struct[[ eosio::table("tallies"), eosio::contract("votemvp") ]] tally {
+    uint32_t votes;     // number of iterations in which the user has voted
+    asset claimed;      // total rewards claimed
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using tally_index = row_store<"tallies"_n, tally>;
+
+// LEADERS
+// the top participants, ranked by votes and then by rewards claimed
+struct[[ eosio::table("leaders"), eosio::contract("votemvp") ]] leader {
+    name user;
+    uint32_t votes;
+    asset claimed;
+
+    uint64_t primary_key() const { return user.value; }
+    uint128_t get_score() const { return leader_score(votes, claimed); }
+    static uint128_t leader_score(uint32_t votes, const asset &claimed) {
+        return (uint128_t(votes) << 64) | uint64_t(claimed.amount);
+    }
+};
+using leaders_index = eosio::multi_index<
+    "leaders"_n, leader,
+    indexed_by<"score"_n,
+               const_mem_fun<leader, uint128_t, &leader::get_score>>>;
+
+// LBSTATE
+// number of rows in the leaderboard
+struct[[ eosio::table("lbstate"), eosio::contract("votemvp") ]] leaderboard_state {
+    uint32_t size;
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using lbstate_index = row_store<"lbstate"_n, leaderboard_state>;
+
+// LBSNAPSHOTS
+// the leaderboard at the end of an iteration - scoped by iteration
+struct[[ eosio::table("lbsnapshots"), eosio::contract("votemvp") ]] leader_snapshot {
+    uint64_t rank;
+    name user;
+    uint32_t votes;
+    asset claimed;
+
+    uint64_t primary_key() const { return rank; }
+};
+using lbsnapshots_index = eosio::multi_index<"lbsnapshots"_n, leader_snapshot>;
+
+
+// PROPOSALS
+// concurrent polls, each with its own schema, open/close window and aggregate
+struct[[ eosio::table("proposals"), eosio::contract("votemvp") ]] proposal {
+    uint64_t id;
+    string question;
+    uint8_t type;           // POLL_AVERAGE or POLL_CHOICE
+    double minimum;         // average polls: lowest accepted response
+    double maximum;         // average polls: highest accepted response
+    uint8_t choices;        // choice polls: number of options
+    time_point opens;
+    time_point closes;
+    uint8_t status;         // POLL_OPEN or POLL_CLOSED
+    uint32_t participants;
+    uint64_t sum;           // average polls: exact sum of responses, in units of 1/VOTE_SCALE
+    vector<uint32_t> tally; // choice polls: number of votes for each option
+    double result;          // set when the poll is finalised - the average, or the winning option
+
+    uint64_t primary_key() const { return id; }
+    // closed polls sort last, so the front of the index is the next poll due to close
+    uint64_t get_closes() const { return status == POLL_OPEN ? closes.time_since_epoch()._count : UINT64_MAX; }
+};
+using proposals_index = eosio::multi_index<
+    "proposals"_n, proposal,
+    indexed_by<"closes"_n,
+               const_mem_fun<proposal, uint64_t, &proposal::get_closes>>>;
+
+// POLLVOTES
+// the users who have voted in a poll - scoped by proposal id
+struct[[ eosio::table("pollvotes"), eosio::contract("votemvp") ]] poll_vote {
+    name user;
+    double response;
+
+    uint64_t primary_key() const { return user.value; }
+};
+using pollvotes_index = eosio::multi_index<"pollvotes"_n, poll_vote>;
+
+
+// ACTIVES
+// the latest iteration in which each user took part - lets the sweeper walk the user scopes
+struct[[ eosio::table("actives"), eosio::contract("votemvp") ]] active {
+    name user;
+    uint32_t last_active;
+
+    uint64_t primary_key() const { return user.value; }
+};
+using actives_index = eosio::multi_index<"actives"_n, active>;
+
+// ACTION COUNTS
+// the calls of an action in one iteration - kept on a row the action writes anyway, and archived at rollover
+struct action_count {
+    uint32_t iteration;     // the iteration recorded in the system row when the calls were made
+    uint32_t calls;
+
+    void add(uint32_t this_iteration) {
+        if (iteration != this_iteration) {
+            iteration = this_iteration;
+            calls = 0;
+        }
+        calls += 1;
+    }
+
+    uint32_t in(uint32_t of_iteration) const { return iteration == of_iteration ? calls : 0; }
+};
+
+// CURSORS
+// progress of resumable, bounded-work jobs
+struct[[ eosio::table("cursors"), eosio::contract("votemvp") ]] job_cursor {
+    name job;
+    uint64_t position;      // primary key at which the next call resumes
+    uint64_t processed;     // rows processed by the job
+    action_count calls;     // calls of the action that runs the job - cron for the sweep, airimport
+
+    uint64_t primary_key() const { return job.value; }
+};
+using cursors_index = eosio::multi_index<"cursors"_n, job_cursor>;
+
+
+// RAMSTATS
+// approximate RAM footprint of each of the contract's tables, across all scopes
+struct[[ eosio::table("ramstats"), eosio::contract("votemvp") ]] ram_stat {
+    name table;
+    int64_t rows;
+    int64_t bytes;          // packed row sizes plus the per-row overhead
+    int64_t start_rows;     // rows at the start of the current iteration
+    int64_t start_bytes;    // bytes at the start of the current iteration
+    int64_t growth_rows;    // rows added over the previous iteration
+    int64_t growth_bytes;   // bytes added over the previous iteration
+    bool seeded;            // the counts include the rows written before accounting began (see ramseed)
+
+    uint64_t primary_key() const { return table.value; }
+};
+using ramstats_index = eosio::multi_index<"ramstats"_n, ram_stat>;
+
+
+// GOVERNANCE RESULTS
+// one finalised outcome, sent to the configuration contract in the iteration's govresults action
+struct gov_outcome {
+    name question;          // lockthresh, or poll
+    uint64_t id;            // the iteration for lockthresh, the poll id for poll
+    double result;          // 0 unless the quorum was reached
+    uint32_t turnout;       // the measure the quorum is decided on - vote weight for lockthresh, participants for poll
+    bool quorum;
+};
+
+// PENDRESULTS
+// outcomes finalised during the iteration, waiting to be sent at rollover
+struct[[ eosio::table("pendresults"), eosio::contract("votemvp") ]] pending_results {
+    vector<gov_outcome> outcomes;
+
+    uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
+};
+using pendresults_index = row_store<"pendresults"_n, pending_results>;
+
+
+// STATS
+// counters of each past iteration, archived at rollover - rejected actions are reverted, so only outcomes are counted
+// actions on a poll, a claim root or a proxy are counted on its own row: the poll's participants, the root's claims
+// and the proxy's delegations
+struct[[ eosio::table("stats"), eosio::contract("votemvp") ]] iteration_stats {
+    uint32_t iteration;
+    uint32_t votes;         // ballots accepted
+    uint32_t amendments;    // ballots replaced
+    uint32_t vote_weight;   // including delegated votes
+    uint32_t crons;         // cron calls that ran the sweep
+    uint32_t price_updates;
+    uint32_t imports;       // airimport calls
+
+    uint64_t primary_key() const { return iteration; }
+};
+using stats_index = eosio::multi_index<"stats"_n, iteration_stats>;
+
+
+// PRICEOBS
+// ring buffer of price observations - each slot holds a price and how long it was in force
+struct[[ eosio::table("priceobs"), eosio::contract("votemvp") ]] price_obs {
+    uint64_t slot;
+    uint64_t price;         // fixed-point, VOTE_SCALE
+    uint32_t duration;      // seconds
+
+    uint64_t primary_key() const { return slot; }
+};
+using priceobs_index = eosio::multi_index<"priceobs"_n, price_obs>;
+
+// TWAP
+// running time-weighted sum over the observations in the ring buffer
+struct[[ eosio::table("twap"), eosio::contract("votemvp") ]] twap_state {
+    uint32_t size;          // slots in the ring buffer
+    uint32_t head;          // next slot to be written
+    uint64_t last_price;    // the latest observation - enters the sum when the next one arrives
+    time_point_sec last_time;
+    uint128_t weighted;     // sum of price * duration over the slots in use
+    uint64_t duration;      // sum of duration over the slots in use
+    action_count updates;   // priceupdate calls
 
     uint64_t primary_key() const { return 0; } // return a constant to ensure a single-row table
 };
-using vote_index = eosio::multi_index<"voterecord"_n, vote_record>;
+using twap_index = row_store<"twap"_n, twap_state>;
+
+
+// RECEIPTS
+// action return values, so that a client sees the post-action state without reading the tables again
+
+struct vote_receipt {
+    uint32_t iteration;
+    double q3response;      // the accepted response
+    bool amendment;         // true if the vote replaced an earlier one in the iteration
+    uint32_t weight;        // weight of the ballot, including delegated votes
+    double q3average;       // the new locking threshold average
+    uint32_t participants;  // number of voters in the iteration
+    uint32_t vote_weight;   // total vote weight in the iteration
+};
+
+struct init_receipt {
+    time_point init;
+    uint32_t iteration;
+};
+
+struct param_receipt {
+    name paramname;
+    name op;                // upsert or erase
+    bool created;           // true if an upsert inserted a new parameter
+};
+
+struct batch_receipt {
+    uint32_t upserted;
+    uint32_t erased;
+};
+
+struct tableop_receipt {
+    uint32_t rows;          // rows handled by this call
+    bool done;              // the operation has reached the end of the table
+    uint64_t processed;     // rows handled by the operation so far
+};
+
+struct import_receipt {
+    uint32_t imported;
+    uint32_t skipped;       // not registered with the AirClaim, already imported, or before the cursor
+    uint64_t processed;     // users imported by the job so far
+};
 
 
 // EXCHANGERATE
@@ -0,0 +1,100 @@
+#!/bin/sh
+# Compare the CPU and RAM cost of the storage backends on the same workload.
+#
+# Builds the contract twice - multi_index (the default) and -DSTORAGE_SINGLETON - deploys each build to its own
+# account on a test chain, pushes every action of the workload to both, and reports the CPU billed, the contract
+# RAM used, the peak heap (linear memory), and the lookups of the rows and values the action context caches and the
+# database reads made for them (printed by the -DBENCH build at the end of each action) of each action.
+#
+# The two accounts must already have keys in the wallet, enough RAM, and the same parameters and test users set up
+# (see workload.txt).
+#
+# usage: bench.sh -u <url> -m <multi_index account> -s <singleton account> [-w workload.txt] [--no-build]
+
+set -e
+
+URL=http://127.0.0.1:8888
+WORKLOAD=$(dirname "$0")/workload.txt
+BUILD=1
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+OUT=$ROOT/tools/bench/build
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -u) URL=$2; shift 2 ;;
+    -m) MULTI=$2; shift 2 ;;
+    -s) SINGLE=$2; shift 2 ;;
+    -w) WORKLOAD=$2; shift 2 ;;
+    --no-build) BUILD=0; shift ;;
+    *) echo "usage: bench.sh -u <url> -m <multi_index account> -s <singleton account> [-w workload.txt] [--no-build]" >&2; exit 1 ;;
+  esac
+done
+
+if [ -z "$MULTI" ] || [ -z "$SINGLE" ]; then
+  echo "both contract accounts are required (-m and -s)" >&2
+  exit 1
+fi
+
+DEFINES="-DFREEOSCONFIG=\"freeoscfg5\" -DFREEBY=\"freeby\" -DFREEOS=\"freeostokens\" -DBENCH"
+
+build() {
+  # $1 = output directory, $2 = extra defines
+  mkdir -p "$1"
+  (cd "$ROOT" && eval eosio-cpp -o "$1/votemvp.wasm" votemvp.cpp $DEFINES $2 --abigen)
+}
+
+if [ $BUILD -eq 1 ]; then
+  build "$OUT/multi_index" ""
+  build "$OUT/singleton" "-DSTORAGE_SINGLETON"
+  cleos -u "$URL" set contract "$MULTI" "$OUT/multi_index" votemvp.wasm votemvp.abi
+  cleos -u "$URL" set contract "$SINGLE" "$OUT/singleton" votemvp.wasm votemvp.abi
+fi
+
+mkdir -p "$OUT"
+
+ram_usage() {
+  cleos -u "$URL" get account "$1" -j | sed -n 's/.*"ram_usage": *\([0-9]*\).*/\1/p'
+}
+
+# push one action - prints "<cpu us> <ram bytes> <heap bytes> <lookups> <reads>", or "failed 0 0 0 0"
+measure() {
+  # $1 = contract, $2 = action, $3 = data, $4 = permission
+  before=$(ram_usage "$1")
+  if output=$(cleos -u "$URL" push action "$1" "$2" "$3" -p "$4" -j 2>&1); then
+    cpu=$(echo "$output" | sed -n 's/.*"cpu_usage_us": *\([0-9]*\).*/\1/p' | head -1)
+    after=$(ram_usage "$1")
+    heap=$(echo "$output" | sed -n 's/.*"console": *"heap \([0-9]*\) .*/\1/p' | head -1)
+    lookups=$(echo "$output" | sed -n 's/.*"console": *"heap [^"]* lookups \([0-9]*\).*/\1/p' | head -1)
+    reads=$(echo "$output" | sed -n 's/.*"console": *"heap [^"]* reads \([0-9]*\).*/\1/p' | head -1)
+    echo "$cpu $((after - before)) ${heap:-0} ${lookups:-0} ${reads:-0}"
+  else
+    echo "failed 0 0 0 0"
+  fi
+}
+
+printf "%-12s %-40s %14s %14s %14s %12s %12s %14s %14s %14s %12s %12s\n" action data multi_cpu_us multi_ram multi_heap \
+  multi_lookups multi_reads single_cpu_us single_ram single_heap single_lookups single_reads
+total_multi_cpu=0; total_multi_ram=0; total_single_cpu=0; total_single_ram=0
+
+# workload lines are: action|data|permission - $CONTRACT in the data or permission is replaced by each account
+grep -v '^#' "$WORKLOAD" | grep -v '^$' | while IFS='|' read -r action data permission; do
+  set -- $(measure "$MULTI" "$action" "$(echo "$data" | sed "s/\$CONTRACT/$MULTI/g")" \
+                   "$(echo "$permission" | sed "s/\$CONTRACT/$MULTI/g")")
+  multi_cpu=$1; multi_ram=$2; multi_heap=$3; multi_lookups=$4; multi_reads=$5
+  set -- $(measure "$SINGLE" "$action" "$(echo "$data" | sed "s/\$CONTRACT/$SINGLE/g")" \
+                   "$(echo "$permission" | sed "s/\$CONTRACT/$SINGLE/g")")
+  single_cpu=$1; single_ram=$2; single_heap=$3; single_lookups=$4; single_reads=$5
+
+  printf "%-12s %-40s %14s %14s %14s %12s %12s %14s %14s %14s %12s %12s\n" "$action" "$data" "$multi_cpu" "$multi_ram" \
+    "$multi_heap" "$multi_lookups" "$multi_reads" "$single_cpu" "$single_ram" "$single_heap" \
+    "$single_lookups" "$single_reads"
+
+  if [ "$multi_cpu" != failed ] && [ "$single_cpu" != failed ]; then
+    total_multi_cpu=$((total_multi_cpu + multi_cpu)); total_multi_ram=$((total_multi_ram + multi_ram))
+    total_single_cpu=$((total_single_cpu + single_cpu)); total_single_ram=$((total_single_ram + single_ram))
+  fi
+  printf "%-12s %-40s %14s %14s %14s %12s %12s %14s %14s %14s %12s %12s\n" total "" "$total_multi_cpu" "$total_multi_ram" "" "" "" \
+    "$total_single_cpu" "$total_single_ram" "" "" "" > "$OUT/totals"
+done
+
+cat "$OUT/totals"
@@ -0,0 +1,200 @@
+#pragma once
+// Minimal JSON reader for the off-chain tools - enough to parse nodeos/cleos output and action traces.
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace freedao {
+namespace json {
+
+struct value {
+  enum kind_t { null_t, bool_t, number_t, string_t, array_t, object_t };
+
+  kind_t kind = null_t;
+  bool boolean = false;
+  std::string text;  // string contents, or the literal text of a number
+  std::vector<value> items;
+  std::map<std::string, value> fields;
+
+  bool is_null() const { return kind == null_t; }
+  bool is_object() const { return kind == object_t; }
+  bool is_array() const { return kind == array_t; }
+
+  // object member, or a shared null value when absent
+  const value &operator[](const std::string &key) const {
+    static const value none;
+    auto it = fields.find(key);
+    return it == fields.end() ? none : it->second;
+  }
+
+  const value &operator[](size_t index) const {
+    static const value none;
+    return index < items.size() ? items[index] : none;
+  }
+
+  size_t size() const { return kind == array_t ? items.size() : fields.size(); }
+
+  // numbers are often sent as strings by nodeos (e.g. 64-bit values), so accept both
+  std::string as_string() const { return text; }
+  double as_double() const { return text.empty() ? 0.0 : std::strtod(text.c_str(), nullptr); }
+  int64_t as_int() const { return text.empty() ? 0 : std::strtoll(text.c_str(), nullptr, 10); }
+  uint64_t as_uint() const { return text.empty() ? 0 : std::strtoull(text.c_str(), nullptr, 10); }
+  bool as_bool() const { return kind == bool_t ? boolean : as_int() != 0; }
+};
+
+class parser {
+public:
+  explicit parser(const std::string &input) : s(input) {}
+
+  value parse() {
+    value v = parse_value();
+    skip_space();
+    if (pos != s.size()) fail("trailing characters");
+    return v;
+  }
+
+private:
+  const std::string &s;
+  size_t pos = 0;
+
+  [[noreturn]] void fail(const char *what) {
+    throw std::runtime_error(std::string("json: ") + what + " at offset " + std::to_string(pos));
+  }
+
+  void skip_space() {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) pos++;
+  }
+
+  bool consume(const char *literal) {
+    size_t n = std::char_traits<char>::length(literal);
+    if (s.compare(pos, n, literal) != 0) return false;
+    pos += n;
+    return true;
+  }
+
+  value parse_value() {
+    skip_space();
+    if (pos >= s.size()) fail("unexpected end of input");
+
+    value v;
+    char c = s[pos];
+    if (c == '{') {
+      v.kind = value::object_t;
+      pos++;
+      skip_space();
+      if (pos < s.size() && s[pos] == '}') { pos++; return v; }
+      while (true) {
+        skip_space();
+        if (pos >= s.size() || s[pos] != '"') fail("expected key");
+        std::string key = parse_string();
+        skip_space();
+        if (pos >= s.size() || s[pos] != ':') fail("expected ':'");
+        pos++;
+        v.fields[key] = parse_value();
+        skip_space();
+        if (pos < s.size() && s[pos] == ',') { pos++; continue; }
+        if (pos < s.size() && s[pos] == '}') { pos++; break; }
+        fail("expected ',' or '}'");
+      }
+    } else if (c == '[') {
+      v.kind = value::array_t;
+      pos++;
+      skip_space();
+      if (pos < s.size() && s[pos] == ']') { pos++; return v; }
+      while (true) {
+        v.items.push_back(parse_value());
+        skip_space();
+        if (pos < s.size() && s[pos] == ',') { pos++; continue; }
+        if (pos < s.size() && s[pos] == ']') { pos++; break; }
+        fail("expected ',' or ']'");
+      }
+    } else if (c == '"') {
+      v.kind = value::string_t;
+      v.text = parse_string();
+    } else if (consume("true")) {
+      v.kind = value::bool_t;
+      v.boolean = true;
+      v.text = "1";
+    } else if (consume("false")) {
+      v.kind = value::bool_t;
+      v.text = "0";
+    } else if (consume("null")) {
+      v.kind = value::null_t;
+    } else {
+      size_t start = pos;
+      while (pos < s.size() && (isdigit((unsigned char) s[pos]) || s[pos] == '-' || s[pos] == '+' ||
+                                s[pos] == '.' || s[pos] == 'e' || s[pos] == 'E')) {
+        pos++;
+      }
+      if (start == pos) fail("unexpected character");
+      v.kind = value::number_t;
+      v.text = s.substr(start, pos - start);
+    }
+    return v;
+  }
+
+  std::string parse_string() {
+    std::string out;
+    pos++;  // opening quote
+    while (pos < s.size() && s[pos] != '"') {
+      char c = s[pos++];
+      if (c != '\\') { out += c; continue; }
+      if (pos >= s.size()) break;
+      char e = s[pos++];
+      switch (e) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': {
+          if (pos + 4 > s.size()) fail("bad escape");
+          unsigned code = std::strtoul(s.substr(pos, 4).c_str(), nullptr, 16);
+          pos += 4;
+          // only the basic multilingual plane is needed for our data
+          if (code < 0x80) {
+            out += (char) code;
+          } else if (code < 0x800) {
+            out += (char) (0xc0 | (code >> 6));
+            out += (char) (0x80 | (code & 0x3f));
+          } else {
+            out += (char) (0xe0 | (code >> 12));
+            out += (char) (0x80 | ((code >> 6) & 0x3f));
+            out += (char) (0x80 | (code & 0x3f));
+          }
+          break;
+        }
+        default: out += e; break;
+      }
+    }
+    if (pos >= s.size()) fail("unterminated string");
+    pos++;  // closing quote
+    return out;
+  }
+};
+
+inline value parse(const std::string &input) { return parser(input).parse(); }
+
+// escape a string for writing as JSON
+inline std::string quote(const std::string &in) {
+  std::string out = "\"";
+  for (char c : in) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      case '\r': out += "\\r"; break;
+      default: out += c; break;
+    }
+  }
+  return out + "\"";
+}
+
+} // namespace json
+} // namespace freedao
@@ -0,0 +1,33 @@
+#pragma once
+// Chain timestamp helpers for the off-chain tools.
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+namespace freedao {
+
+// parse a chain timestamp such as "2021-09-15T00:00:00.000" (UTC) into microseconds since the epoch
+inline int64_t parse_time_us(const std::string &text) {
+  struct tm t = {};
+  int millis = 0;
+  if (sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d.%d", &t.tm_year, &t.tm_mon, &t.tm_mday,
+             &t.tm_hour, &t.tm_min, &t.tm_sec, &millis) < 6) {
+    return 0;
+  }
+  t.tm_year -= 1900;
+  t.tm_mon -= 1;
+  return (int64_t) timegm(&t) * 1000000 + (int64_t) millis * 1000;
+}
+
+inline std::string format_time_us(int64_t us) {
+  time_t secs = us / 1000000;
+  struct tm t;
+  gmtime_r(&secs, &t);
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03d", t.tm_year + 1900, t.tm_mon + 1,
+           t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, (int) ((us / 1000) % 1000));
+  return buffer;
+}
+
+} // namespace freedao
@@ -0,0 +1 @@
+g++ -std=c++17 -O2 -Wall -o indexer indexer.cpp
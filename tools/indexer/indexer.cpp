@@ -0,0 +1,335 @@
+// votemvp indexer
+//
+// Builds materialized views of the votemvp contract from its action traces:
+//   iterations.tsv - per-iteration results (voters, vote weight, running and final locking threshold, quorum)
+//   users.tsv      - per-user participation (votes, amendments, first and last iteration voted)
+//   thresholds.tsv - locking threshold history, one line per rollover
+//
+// Input is one JSON action trace per line - a recorded trace file, or '-' to read a live stream on stdin (e.g.
+// from a state-history to JSON bridge). Each trace needs act.account, act.name and act.data, and may carry
+// receiver, block_num, block_time and global_sequence (at the top level or in receipt).
+//
+// Views are rebuilt incrementally from the logvote and logrollover events. They are snapshotted to one file in the
+// view directory together with a checkpoint (global sequence and file offset), so a restart resumes where the last
+// snapshot left off instead of replaying the whole history, and never applies an action twice. The .tsv views are
+// exported from each snapshot.
+//
+// usage: indexer -d <view directory> [-c votemvp] [--snapshot <actions>] <trace file | ->
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/json.hpp"
+
+using namespace std;
+using namespace freedao;
+
+struct iteration_view {
+  uint32_t voters = 0;            // ballots cast (not counting amendments)
+  uint32_t vote_weight = 0;       // including delegated votes
+  uint32_t amendments = 0;
+  double q3average = 0.0;         // running locking threshold average
+  uint32_t participants = 0;      // system participants at rollover
+  double locking_threshold = 0.0; // final locking threshold at rollover
+  bool quorum = false;
+  bool closed = false;
+};
+
+struct user_view {
+  uint32_t votes = 0;
+  uint32_t amendments = 0;
+  uint32_t first_iteration = 0;
+  uint32_t last_iteration = 0;
+};
+
+struct threshold_point {
+  uint32_t iteration = 0;
+  string block_time;
+  double locking_threshold = 0.0;
+  bool quorum = false;
+};
+
+struct checkpoint {
+  uint64_t global_sequence = 0;
+  uint64_t offset = 0;
+  string source;
+};
+
+class views {
+public:
+  map<uint32_t, iteration_view> iterations;
+  map<string, user_view> users;
+  vector<threshold_point> thresholds;
+  checkpoint position;
+
+  // the views and the checkpoint are restored from the snapshot file only - the .tsv files are exports of it
+  void load(const string &dir) {
+    ifstream in(dir + "/snapshot");
+    if (!in) return;
+
+    vector<string> f;
+    if (!read_row(in, f, 3) || f[0] != "checkpoint") throw runtime_error("snapshot has no checkpoint");
+    position.global_sequence = stoull(f[1]);
+    position.offset = stoull(f[2]);
+    position.source = f.size() > 3 ? f[3] : "";
+
+    for (uint64_t n = section(in, "iterations"); n > 0; n--) {
+      if (!read_row(in, f, 9)) throw runtime_error("snapshot is truncated");
+      iteration_view &v = iterations[stoul(f[0])];
+      v.voters = stoul(f[1]);
+      v.vote_weight = stoul(f[2]);
+      v.amendments = stoul(f[3]);
+      v.q3average = stod(f[4]);
+      v.participants = stoul(f[5]);
+      v.locking_threshold = stod(f[6]);
+      v.quorum = f[7] == "1";
+      v.closed = f[8] == "1";
+    }
+
+    for (uint64_t n = section(in, "users"); n > 0; n--) {
+      if (!read_row(in, f, 5)) throw runtime_error("snapshot is truncated");
+      user_view &v = users[f[0]];
+      v.votes = stoul(f[1]);
+      v.amendments = stoul(f[2]);
+      v.first_iteration = stoul(f[3]);
+      v.last_iteration = stoul(f[4]);
+    }
+
+    for (uint64_t n = section(in, "thresholds"); n > 0; n--) {
+      if (!read_row(in, f, 4)) throw runtime_error("snapshot is truncated");
+      thresholds.push_back({(uint32_t) stoul(f[0]), f[1], stod(f[2]), f[3] == "1"});
+    }
+  }
+
+  // the views and the checkpoint are written together to one file, which is renamed into place, so a crash leaves
+  // either the old snapshot or the new one - then the views are exported, one file each
+  void save(const string &dir) const {
+    write(dir, "snapshot", [&](ostream &out) {
+      out << "checkpoint\t" << position.global_sequence << '\t' << position.offset << '\t' << position.source << '\n';
+      out << "iterations\t" << iterations.size() << '\n';
+      write_iterations(out);
+      out << "users\t" << users.size() << '\n';
+      write_users(out);
+      out << "thresholds\t" << thresholds.size() << '\n';
+      write_thresholds(out);
+    });
+
+    write(dir, "iterations.tsv", [&](ostream &out) {
+      out << "iteration\tvoters\tvote_weight\tamendments\tq3average\tparticipants\tlocking_threshold\tquorum\tclosed\n";
+      write_iterations(out);
+    });
+    write(dir, "users.tsv", [&](ostream &out) {
+      out << "user\tvotes\tamendments\tfirst_iteration\tlast_iteration\n";
+      write_users(out);
+    });
+    write(dir, "thresholds.tsv", [&](ostream &out) {
+      out << "iteration\tblock_time\tlocking_threshold\tquorum\n";
+      write_thresholds(out);
+    });
+  }
+
+  // apply one action trace - returns true if it changed a view
+  bool apply(const json::value &trace, const string &contract) {
+    const json::value &act = trace["act"];
+    if (act["account"].as_string() != contract) return false;
+
+    // each inline action is also seen by notified accounts - count it once, for the contract itself
+    string receiver = trace["receiver"].as_string();
+    if (receiver.empty()) receiver = trace["receipt"]["receiver"].as_string();
+    if (!receiver.empty() && receiver != contract) return false;
+
+    const string name = act["name"].as_string();
+    const json::value &data = act["data"];
+
+    if (name == "logvote") {
+      uint32_t iteration = data["iteration"].as_uint();
+      bool amendment = data["amendment"].as_bool();
+
+      iteration_view &it = iterations[iteration];
+      it.vote_weight = data["total_weight"].as_uint();
+      it.voters = data["participants"].as_uint();
+      it.q3average = data["q3average"].as_double();
+      if (amendment) it.amendments++;
+
+      user_view &u = users[data["user"].as_string()];
+      if (amendment) {
+        u.amendments++;
+      } else {
+        u.votes++;
+        if (u.first_iteration == 0) u.first_iteration = iteration;
+        u.last_iteration = iteration;
+      }
+      return true;
+    }
+
+    if (name == "logrollover") {
+      uint32_t iteration = data["old_iteration"].as_uint();
+
+      iteration_view &it = iterations[iteration];
+      it.participants = data["participants"].as_uint();
+      it.voters = data["voters"].as_uint();
+      it.vote_weight = data["vote_weight"].as_uint();
+      it.locking_threshold = data["locking_threshold"].as_double();
+      it.quorum = data["quorum"].as_bool();
+      it.closed = true;
+
+      string block_time = trace["block_time"].as_string();
+      if (block_time.empty()) block_time = trace["@timestamp"].as_string();
+      thresholds.push_back({iteration, block_time, it.locking_threshold, it.quorum});
+      return true;
+    }
+
+    return false;
+  }
+
+private:
+  void write_iterations(ostream &out) const {
+    for (const auto &[iteration, v] : iterations) {
+      out << iteration << '\t' << v.voters << '\t' << v.vote_weight << '\t' << v.amendments << '\t' << v.q3average
+          << '\t' << v.participants << '\t' << v.locking_threshold << '\t' << v.quorum << '\t' << v.closed << '\n';
+    }
+  }
+
+  void write_users(ostream &out) const {
+    for (const auto &[user, v] : users) {
+      out << user << '\t' << v.votes << '\t' << v.amendments << '\t' << v.first_iteration << '\t' << v.last_iteration
+          << '\n';
+    }
+  }
+
+  // the block time may be empty - fields are separated by tabs, so an empty field still parses
+  void write_thresholds(ostream &out) const {
+    for (const auto &p : thresholds) {
+      out << p.iteration << '\t' << p.block_time << '\t' << p.locking_threshold << '\t' << p.quorum << '\n';
+    }
+  }
+
+  // one line split on tabs - false at the end of the file or if it has fewer than 'fields' fields
+  static bool read_row(istream &in, vector<string> &fields, size_t minimum) {
+    string line;
+    if (!getline(in, line)) return false;
+    fields.clear();
+    size_t start = 0, tab;
+    while ((tab = line.find('\t', start)) != string::npos) {
+      fields.push_back(line.substr(start, tab - start));
+      start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return fields.size() >= minimum;
+  }
+
+  // a section header - returns its row count
+  static uint64_t section(istream &in, const string &name) {
+    vector<string> fields;
+    if (!read_row(in, fields, 2) || fields[0] != name) throw runtime_error("snapshot has no " + name + " section");
+    return stoull(fields[1]);
+  }
+
+  template <typename F> void write(const string &dir, const string &file, F body) const {
+    string path = dir + "/" + file;
+    string temporary = path + ".tmp";
+    {
+      ofstream out(temporary, ios::trunc);
+      out.precision(10);
+      body(out);
+      if (!out) throw runtime_error("unable to write " + temporary);
+    }
+    if (rename(temporary.c_str(), path.c_str()) != 0) throw runtime_error("unable to replace " + path);
+  }
+};
+
+uint64_t global_sequence_of(const json::value &trace) {
+  uint64_t sequence = trace["global_sequence"].as_uint();
+  return sequence != 0 ? sequence : trace["receipt"]["global_sequence"].as_uint();
+}
+
+void usage() {
+  cerr << "usage: indexer -d <view directory> [-c votemvp] [--snapshot <actions>] <trace file | ->" << endl;
+}
+
+int main(int argc, char **argv) {
+  string dir, contract = "votemvp", source;
+  uint64_t snapshot_every = 100000;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if ((arg == "-d" || arg == "-c" || arg == "--snapshot") && i + 1 >= argc) {
+      usage();
+      return 1;
+    }
+    if (arg == "-d") dir = argv[++i];
+    else if (arg == "-c") contract = argv[++i];
+    else if (arg == "--snapshot") snapshot_every = stoull(argv[++i]);
+    else source = arg;
+  }
+
+  if (dir.empty() || source.empty()) {
+    usage();
+    return 1;
+  }
+
+  views state;
+  state.load(dir);
+
+  // a recorded file can be resumed from the checkpoint offset
+  ifstream file;
+  istream *in = &cin;
+  uint64_t offset = 0;
+  if (source != "-") {
+    file.open(source, ios::binary);
+    if (!file) {
+      cerr << "unable to open " << source << endl;
+      return 1;
+    }
+    if (state.position.source == source) {
+      file.seekg(0, ios::end);
+      if ((uint64_t) file.tellg() >= state.position.offset) offset = state.position.offset;
+      file.seekg(offset);
+    }
+    in = &file;
+  }
+
+  string line;
+  uint64_t applied = 0, since_snapshot = 0, lines = 0;
+
+  while (getline(*in, line)) {
+    offset += line.size() + 1;
+    lines++;
+    if (line.empty()) continue;
+
+    json::value trace;
+    try {
+      trace = json::parse(line);
+    } catch (const exception &e) {
+      cerr << "skipping line " << lines << ": " << e.what() << endl;
+      continue;
+    }
+
+    // already applied before the last snapshot
+    uint64_t sequence = global_sequence_of(trace);
+    if (sequence != 0 && sequence <= state.position.global_sequence) continue;
+
+    if (state.apply(trace, contract)) {
+      applied++;
+      since_snapshot++;
+    }
+    if (sequence != 0) state.position.global_sequence = sequence;
+    state.position.offset = source == "-" ? 0 : offset;
+    state.position.source = source;
+
+    if (since_snapshot >= snapshot_every) {
+      state.save(dir);
+      since_snapshot = 0;
+    }
+  }
+
+  state.save(dir);
+  cerr << "read " << lines << " traces, applied " << applied << " actions, " << state.iterations.size()
+       << " iterations, " << state.users.size() << " users" << endl;
+  return 0;
+}
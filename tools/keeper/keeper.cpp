@@ -0,0 +1,299 @@
+// votemvp keeper
+//
+// Drives the contract's periodic work from an operations account, so that iteration rollover is never paid for
+// by a voter. The keeper reads the iteration calendar and the votemvp system row, pushes cron just after each
+// iteration boundary, and keeps pushing cron until the rollover work (including expired polls) is done.
+//
+// All chain access goes through cleos, so the keeper can be pointed at any nodeos - including a local test chain
+// - with -u, and at a stand-in cleos with --cleos.
+//
+// usage: keeper -u <url> -p <actor@permission> [-c votemvp] [--config <account>] [--grace <s>] [--poll <s>]
+//               [--rounds <n>] [--cleos <path>] [--once] [--dry-run]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/json.hpp"
+#include "../common/time.hpp"
+
+using namespace std;
+using namespace freedao;
+
+struct options {
+  string url = "http://127.0.0.1:8888";
+  string contract = "votemvp";
+  string permission;            // e.g. freeosops@active
+  string config_account;        // calendar account - read from the configacct parameter when not given
+  string cleos = "cleos";
+  int grace_seconds = 2;        // delay after a boundary before pushing cron
+  int poll_seconds = 60;        // longest sleep between checks
+  int max_rounds = 20;          // cron pushes per boundary before giving up until the next check
+  bool once = false;
+  bool dry_run = false;
+};
+
+void log_line(const string &message) {
+  auto now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+  cerr << format_time_us(now) << " " << message << endl;
+}
+
+// quote an argument for the shell
+string shell_quote(const string &arg) {
+  string out = "'";
+  for (char c : arg) {
+    if (c == '\'') out += "'\\''";
+    else out += c;
+  }
+  return out + "'";
+}
+
+// chain access through cleos
+class chain {
+public:
+  explicit chain(const options &opts) : opts(opts) {}
+
+  json::value info() { return json::parse(run({"get", "info"})); }
+
+  int64_t head_time_us() { return parse_time_us(info()["head_block_time"].as_string()); }
+
+  // all rows of a table, following the 'more' pagination
+  vector<json::value> rows(const string &code, const string &scope, const string &table,
+                           const vector<string> &extra = {}) {
+    vector<json::value> result;
+    string lower;
+    while (true) {
+      vector<string> args = {"get", "table", code, scope, table, "-l", "100"};
+      args.insert(args.end(), extra.begin(), extra.end());
+      if (!lower.empty()) {
+        args.push_back("-L");
+        args.push_back(lower);
+      }
+      json::value page = json::parse(run(args));
+      for (const auto &row : page["rows"].items) result.push_back(row);
+      if (!page["more"].as_bool() || page["next_key"].as_string().empty()) break;
+      lower = page["next_key"].as_string();
+    }
+    return result;
+  }
+
+  // the first row of a table or index
+  json::value first_row(const string &code, const string &scope, const string &table,
+                        const vector<string> &extra = {}) {
+    vector<string> args = {"get", "table", code, scope, table, "-l", "1"};
+    args.insert(args.end(), extra.begin(), extra.end());
+    json::value page = json::parse(run(args));
+    return page["rows"][0];
+  }
+
+  // push an action - returns false with the error text on failure
+  bool push(const string &action, const string &data, string &error) {
+    vector<string> args = {"push", "action", opts.contract, action, data, "-p", opts.permission, "-j"};
+    if (opts.dry_run) {
+      log_line("dry run: cleos " + join(args));
+      return true;
+    }
+    int status = 0;
+    string output = run(args, &status);
+    if (status == 0) return true;
+    // the same cron pushed twice in one block is rejected as a duplicate - it has already been applied
+    if (output.find("Duplicate transaction") != string::npos) return true;
+    error = output;
+    return false;
+  }
+
+private:
+  const options &opts;
+
+  string join(const vector<string> &args) {
+    string out;
+    for (const auto &arg : args) out += (out.empty() ? "" : " ") + shell_quote(arg);
+    return out;
+  }
+
+  string run(const vector<string> &args, int *status = nullptr) {
+    string command = shell_quote(opts.cleos) + " -u " + shell_quote(opts.url) + " " + join(args) + " 2>&1";
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) throw runtime_error("unable to run cleos");
+
+    string output;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) output.append(buffer, n);
+
+    int rc = pclose(pipe);
+    if (status) {
+      *status = rc;
+    } else if (rc != 0) {
+      throw runtime_error("cleos " + args[0] + " " + args[1] + " failed: " + output);
+    }
+    return output;
+  }
+};
+
+struct calendar_entry {
+  uint32_t iteration;
+  int64_t start_us;
+  int64_t end_us;
+};
+
+class keeper {
+public:
+  explicit keeper(const options &opts) : opts(opts), node(opts) {}
+
+  // one check - returns the number of seconds until the next check is due
+  int64_t check_once() {
+    load_calendar();
+
+    int64_t now = node.head_time_us();
+    uint32_t calendar_iteration = iteration_at(now);
+    uint32_t recorded_iteration = system_iteration();
+
+    if (calendar_iteration != recorded_iteration || polls_due(now)) {
+      advance(now);
+    }
+
+    // sleep until just after the next boundary, or the poll interval if sooner
+    int64_t next = next_boundary(now);
+    int64_t wait = opts.poll_seconds;
+    if (next > 0) wait = min<int64_t>(wait, (next - now) / 1000000 + opts.grace_seconds);
+    return max<int64_t>(wait, 1);
+  }
+
+  void run() {
+    int64_t backoff = 1;
+    while (true) {
+      int64_t wait;
+      try {
+        wait = check_once();
+        backoff = 1;
+      } catch (const exception &e) {
+        wait = backoff;
+        log_line(string("error: ") + e.what() + " - retrying in " + to_string(wait) + "s");
+        backoff = min<int64_t>(backoff * 2, 300);
+      }
+      if (opts.once) break;
+      this_thread::sleep_for(chrono::seconds(wait));
+    }
+  }
+
+private:
+  const options &opts;
+  chain node;
+  string config_account;
+  vector<calendar_entry> calendar;
+
+  void load_calendar() {
+    if (config_account.empty()) {
+      config_account = opts.config_account;
+    }
+    if (config_account.empty()) {
+      json::value parameter = node.first_row(opts.contract, opts.contract, "parameters",
+                                             {"-L", "configacct", "-U", "configacct", "--key-type", "name"});
+      config_account = parameter["value"].as_string();
+      if (config_account.empty()) throw runtime_error("configacct parameter is not defined");
+    }
+
+    calendar.clear();
+    for (const auto &row : node.rows(config_account, config_account, "iterations")) {
+      calendar.push_back({(uint32_t) row["iteration_number"].as_uint(), parse_time_us(row["start"].as_string()),
+                          parse_time_us(row["end"].as_string())});
+    }
+    sort(calendar.begin(), calendar.end(),
+         [](const calendar_entry &a, const calendar_entry &b) { return a.start_us < b.start_us; });
+  }
+
+  // the iteration in progress at the given time - the same rule as current_iteration() in the contract
+  uint32_t iteration_at(int64_t now) const {
+    for (auto it = calendar.rbegin(); it != calendar.rend(); ++it) {
+      if (it->start_us <= now) return now <= it->end_us ? it->iteration : 0;
+    }
+    return 0;
+  }
+
+  int64_t next_boundary(int64_t now) const {
+    for (const auto &entry : calendar) {
+      if (entry.start_us > now) return entry.start_us;
+      if (entry.end_us >= now) return entry.end_us + 1;
+    }
+    return 0;
+  }
+
+  uint32_t system_iteration() {
+    json::value system = node.first_row(opts.contract, opts.contract, "system");
+    if (system.is_null()) throw runtime_error("system record is undefined");
+    return (uint32_t) system["iteration"].as_uint();
+  }
+
+  // is there an open poll whose closing time has passed?
+  bool polls_due(int64_t now) {
+    json::value poll = node.first_row(opts.contract, opts.contract, "proposals", {"--index", "2", "--key-type", "i64"});
+    return !poll.is_null() && poll["status"].as_uint() == 0 && parse_time_us(poll["closes"].as_string()) <= now;
+  }
+
+  // push cron until the rollover is recorded and no expired polls remain
+  void advance(int64_t now) {
+    for (int round = 1; round <= opts.max_rounds; round++) {
+      string error;
+      if (!node.push("cron", "[]", error)) throw runtime_error("cron failed: " + error);
+      log_line("cron pushed (round " + to_string(round) + ")");
+
+      if (opts.dry_run) return;
+
+      now = node.head_time_us();
+      if (iteration_at(now) == system_iteration() && !polls_due(now)) return;
+    }
+    log_line("rollover work is not yet complete after " + to_string(opts.max_rounds) + " rounds");
+  }
+};
+
+void usage() {
+  cerr << "usage: keeper -u <url> -p <actor@permission> [-c votemvp] [--config <account>] [--grace <s>]"
+          " [--poll <s>] [--rounds <n>] [--cleos <path>] [--once] [--dry-run]"
+       << endl;
+}
+
+int main(int argc, char **argv) {
+  options opts;
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    auto next = [&]() -> string {
+      if (i + 1 >= argc) {
+        usage();
+        exit(1);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "-u") opts.url = next();
+    else if (arg == "-p") opts.permission = next();
+    else if (arg == "-c") opts.contract = next();
+    else if (arg == "--config") opts.config_account = next();
+    else if (arg == "--cleos") opts.cleos = next();
+    else if (arg == "--grace") opts.grace_seconds = stoi(next());
+    else if (arg == "--poll") opts.poll_seconds = stoi(next());
+    else if (arg == "--rounds") opts.max_rounds = stoi(next());
+    else if (arg == "--once") opts.once = true;
+    else if (arg == "--dry-run") opts.dry_run = true;
+    else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (opts.permission.empty()) {
+    usage();
+    return 1;
+  }
+
+  keeper(opts).run();
+  return 0;
+}
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Run the keeper against the stand-in cleos (standin/cleos) through an iteration boundary, a duplicate cron
+# transaction and a node outage, checking what it pushes and how it backs off.
+#
+# usage: test.sh
+
+set -e
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+g++ -std=c++17 -O2 -Wall -o "$WORK/keeper" "$DIR/keeper.cpp"
+
+export STANDIN=$WORK/chain
+KEEPER="$WORK/keeper -u http://standin -p freeosops@active --cleos $DIR/standin/cleos"
+FAILED=0
+
+# a fresh chain - iteration 1 runs for the whole of 1 January, iteration 2 for 2 January
+reset_chain() {
+  rm -rf "$STANDIN"
+  mkdir -p "$STANDIN"
+  echo '{"iteration_number": 1, "start": "2021-01-01T00:00:00.000", "end": "2021-01-01T23:59:59.000"},
+        {"iteration_number": 2, "start": "2021-01-02T00:00:00.000", "end": "2021-01-02T23:59:59.000"}' \
+    > "$STANDIN/iterations"
+  echo 1 > "$STANDIN/system"
+  echo 2 > "$STANDIN/current"
+  : > "$STANDIN/pushes"
+}
+
+expect() {
+  # $1 = description, $2 = expected, $3 = actual
+  if [ "$2" = "$3" ]; then
+    echo "ok: $1"
+  else
+    echo "FAILED: $1 - expected '$2', got '$3'"
+    FAILED=1
+  fi
+}
+
+# before the boundary there is nothing to do
+reset_chain
+echo 2021-01-01T12:00:00.000 > "$STANDIN/now"
+$KEEPER --once 2> "$WORK/log"
+expect "no push within an iteration" 0 "$(wc -l < "$STANDIN/pushes")"
+
+# just after the boundary a single cron rolls the iteration over
+echo 2021-01-02T00:00:05.000 > "$STANDIN/now"
+$KEEPER --once 2> "$WORK/log"
+expect "one cron at the boundary" "cron []" "$(cat "$STANDIN/pushes")"
+expect "rollover recorded" 2 "$(cat "$STANDIN/system")"
+
+# a cron that was already applied is reported as a duplicate - it counts as done, and is not pushed again
+reset_chain
+echo 2021-01-02T00:00:05.000 > "$STANDIN/now"
+touch "$STANDIN/duplicate"
+$KEEPER --once 2> "$WORK/log"
+expect "duplicate cron treated as applied" 1 "$(wc -l < "$STANDIN/pushes")"
+expect "no error on a duplicate" 0 "$(grep -c error "$WORK/log" || true)"
+
+# while the node is unreachable the keeper retries after 1, 2 and 4 seconds, then carries on
+reset_chain
+echo 2021-01-02T00:00:05.000 > "$STANDIN/now"
+echo 3 > "$STANDIN/fail"
+timeout 10 $KEEPER --poll 60 2> "$WORK/log" || true
+expect "backoff delays" "1 2 4" "$(sed -n 's/.*retrying in \([0-9]*\)s.*/\1/p' "$WORK/log" | tr '\n' ' ' | sed 's/ $//')"
+expect "cron pushed after the outage" "cron []" "$(cat "$STANDIN/pushes")"
+
+exit $FAILED
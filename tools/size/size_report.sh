@@ -0,0 +1,77 @@
+#!/bin/sh
+# Per-function size report for a wasm that still has its name section.
+#
+# Writes one line per function - name, body size in bytes and instruction count - to <report.tsv>, and, when a
+# previous report is given, prints the functions whose size or instruction count changed, largest change first,
+# followed by the totals.
+#
+# usage: size_report.sh <file.wasm> <report.tsv> [previous.tsv]
+
+set -e
+
+WASM=$1
+REPORT=$2
+PREVIOUS=$3
+
+if [ -z "$WASM" ] || [ -z "$REPORT" ]; then
+  echo "usage: size_report.sh <file.wasm> <report.tsv> [previous.tsv]" >&2
+  exit 1
+fi
+
+# function body sizes, from the code section details:  - func[12] size=345 <name>
+wasm-objdump -x -j Code "$WASM" | awk '
+  /^ - func\[/ {
+    index_ = $2; sub(/^func\[/, "", index_); sub(/\]$/, "", index_)
+    size = $3; sub(/^size=/, "", size)
+    name = $0; if (sub(/.*</, "", name)) sub(/>$/, "", name); else name = "func[" index_ "]"
+    print index_ "\t" name "\t" size
+  }' > "$REPORT.sizes"
+
+# instruction counts, from the disassembly - a line with text after the | is one instruction
+wasm-objdump -d "$WASM" | awk '
+  / func\[[0-9]+\]/ {
+    if (current != "") print current "\t" count
+    current = $2; sub(/^func\[/, "", current); sub(/\].*$/, "", current)
+    count = 0
+    next
+  }
+  /\|/ {
+    text = $0; sub(/^[^|]*\|/, "", text)
+    if (text ~ /[^ ]/) count++
+  }
+  END { if (current != "") print current "\t" count }' > "$REPORT.instructions"
+
+# join on the function index, sorted by size
+{
+  printf "function\tsize\tinstructions\n"
+  awk -F'\t' 'NR == FNR { instructions[$1] = $2; next } { print $2 "\t" $3 "\t" (instructions[$1] + 0) }' \
+    "$REPORT.instructions" "$REPORT.sizes" | sort -t "$(printf '\t')" -k2,2nr
+} > "$REPORT"
+rm "$REPORT.sizes" "$REPORT.instructions"
+
+awk -F'\t' 'NR > 1 { size += $2; instructions += $3; functions++ }
+  END { printf "%d functions, %d bytes, %d instructions\n", functions, size, instructions }' "$REPORT"
+
+if [ -z "$PREVIOUS" ] || [ ! -f "$PREVIOUS" ]; then exit 0; fi
+
+# compare with the previous build - functions are matched by name
+echo "changes since the previous build:"
+awk -F'\t' -v total="$REPORT.total" '
+  FNR == 1 { next }
+  NR == FNR { old_size[$1] = $2; old_instructions[$1] = $3; next }
+  {
+    seen[$1] = 1
+    d_size = $2 - old_size[$1]; d_instructions = $3 - old_instructions[$1]
+    if (!($1 in old_size)) printf "%+d\t%+d\t%s (new)\n", $2, $3, $1
+    else if (d_size != 0 || d_instructions != 0) printf "%+d\t%+d\t%s\n", d_size, d_instructions, $1
+    total_size += d_size; total_instructions += d_instructions
+  }
+  END {
+    for (f in old_size) if (!(f in seen)) {
+      printf "%+d\t%+d\t%s (removed)\n", -old_size[f], -old_instructions[f], f
+      total_size -= old_size[f]; total_instructions -= old_instructions[f]
+    }
+    printf "%+d\t%+d\ttotal\n", total_size, total_instructions > total
+  }' "$PREVIOUS" "$REPORT" | awk -F'\t' '{ d = $1 < 0 ? -$1 : $1; print d "\t" $0 }' | sort -k1,1nr | cut -f2-
+cat "$REPORT.total"
+rm "$REPORT.total"
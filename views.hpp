@@ -0,0 +1,131 @@
+#pragma once
+#include <eosio/eosio.hpp>
+
+#include <cstring>
+#include <string_view>
+
+#include "arena.hpp"
+
+using namespace eosio;
+
+namespace freedao {
+
+// Partial row views
+// A view reads the serialised bytes of another contract's row with db_get_i64 and decodes only the fields it is asked
+// for, in place, instead of unpacking the whole row into its struct with all of its strings and vectors. Where the
+// fields needed are at the front of the row, only those bytes are copied out of the database, into the action arena.
+
+class row_view {
+public:
+  // a row found by the database iterator - copy at most 'limit' bytes of it, or all of it when 'limit' is 0
+  row_view(int32_t iterator, uint32_t limit = 0) {
+    if (iterator < 0) return;
+
+    uint32_t size = internal_use_do_not_use::db_get_i64(iterator, nullptr, 0);
+    if (limit != 0 && limit < size) size = limit;
+
+    bytes.resize(size);
+    internal_use_do_not_use::db_get_i64(iterator, bytes.data(), size);
+    found = true;
+  }
+
+  bool exists() const { return found; }
+
+protected:
+  // a fixed-size field at a known offset
+  template <typename T> T field(uint32_t offset) const {
+    check(offset + sizeof(T) <= bytes.size(), "row is shorter than expected");
+    T value;
+    memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+  }
+
+  // the length prefix of a string or vector at 'offset', which is moved past it
+  uint32_t length(uint32_t &offset) const {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+      uint8_t b = field<uint8_t>(offset++);
+      value |= uint32_t(b & 0x7f) << shift;
+      if (!(b & 0x80)) return value;
+    }
+    check(false, "row has an invalid length");
+    return 0;
+  }
+
+  // a string at 'offset', which is moved past it - the view points into the row's bytes
+  std::string_view text(uint32_t &offset) const {
+    uint32_t size = length(offset);
+    check(offset + size <= bytes.size(), "row is shorter than expected");
+    std::string_view value(bytes.data() + offset, size);
+    offset += size;
+    return value;
+  }
+
+private:
+  arena_vector<char> bytes;
+  bool found = false;
+};
+
+// the staking fields of a user's record in the AirClaim users table (airclaim_user) - the row's first 25 bytes
+class airclaim_user_view : public row_view {
+public:
+  airclaim_user_view(name code, name user)
+      : row_view(internal_use_do_not_use::db_lowerbound_i64(code.value, user.value, "users"_n.value, 0), STAKED_END) {}
+
+  uint32_t staked_iteration() const { return field<uint32_t>(STAKED_ITERATION); }
+
+private:
+  // stake (asset, 16 bytes), account_type (1 byte), registered_iteration (4 bytes), staked_iteration
+  static constexpr uint32_t STAKED_ITERATION = 21;
+  static constexpr uint32_t STAKED_END = STAKED_ITERATION + sizeof(uint32_t);
+};
+
+// the amount of a token balance in an accounts table (account)
+class balance_view : public row_view {
+public:
+  balance_view(name code, name owner, symbol_code currency)
+      : row_view(internal_use_do_not_use::db_find_i64(code.value, owner.value, "accounts"_n.value, currency.raw()),
+                 sizeof(int64_t)) {}
+
+  int64_t amount() const { return exists() ? field<int64_t>(0) : 0; }
+};
+
+// the verification fields of a user's record in the usersinfo table (userinfo)
+class userinfo_view : public row_view {
+public:
+  userinfo_view(name code, name user)
+      : row_view(internal_use_do_not_use::db_find_i64(code.value, code.value, "usersinfo"_n.value, user.value)) {}
+
+  // verified, with a kyc level that includes the user's first and last names
+  bool name_verified() const {
+    uint32_t offset = sizeof(uint64_t);  // acc
+    text(offset);                        // name
+    text(offset);                        // avatar
+
+    bool verified = field<uint8_t>(offset) != 0;
+    if (!verified) return false;
+    offset += 1 + 3 * sizeof(uint64_t);  // verified, date, verifiedon, verifier
+
+    offset += length(offset) * sizeof(uint64_t);      // raccs
+    offset += length(offset) * 2 * sizeof(uint64_t);  // aacts
+    for (uint32_t i = length(offset); i > 0; i--) {   // ac
+      offset += sizeof(uint64_t);
+      text(offset);
+    }
+
+    for (uint32_t i = length(offset); i > 0; i--) {   // kyc
+      offset += sizeof(uint64_t);                     // kyc_provider
+      std::string_view kyc_level = text(offset);
+      offset += sizeof(uint64_t);                     // kyc_date
+
+      if (kyc_level.find("firstname") != std::string_view::npos &&
+          kyc_level.find("lastname") != std::string_view::npos) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+};
+
+} // end of namespace freedao
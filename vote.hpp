@@ -5,83 +5,141 @@
 #include "tables.hpp"
 #include "config.hpp"
 
+#include <charconv>
+
 using namespace eosio;
 using namespace freedao;
 using namespace std;
 
 void freeosgov::vote_init() {
-    vote_index vote_table(get_self(), get_self().value);
-    auto vote_iterator = vote_table.begin();
+    vote_index &vote_table = vote_records();
 
-    if (vote_iterator == vote_table.end()) {
+    if (vote_table.begin() == vote_table.end()) {
         // emplace
-        vote_table.emplace(get_self(), [&](auto &v) { v.iteration = current_iteration(); });
+        auto new_iterator = vote_table.emplace(get_self(), [&](auto &v) {
+            v.iteration = current_iteration();
+            v.weight.emplace(0);
+            v.q3sum.emplace(0);
+            v.amendments.emplace(0);
+        });
+        ram_emplaced("voterecord"_n, *new_iterator);
     }
 }
 
 // rest the vote record, ready for the new iteration
 void freeosgov::vote_reset() {
-    vote_index vote_table(get_self(), get_self().value);
-    auto vote_iterator = vote_table.begin();
-
-    if (vote_iterator != vote_table.end()) {
-        vote_table.modify(vote_iterator, get_self(), [&](auto &vote) {
-            vote.iteration = current_iteration();
-            vote.participants = 0;
-            vote.q1average = 0.0;
-            vote.q2average = 0.0;
-            vote.q3average = 0.0;
-            vote.q4choice1 = 0;   // POOL
-            vote.q4choice2 = 0;   // BURN
-            vote.q5average = 0.0;
-            vote.q6choice1 = 0;
-            vote.q6choice2 = 0;
-            vote.q6choice3 = 0;
-            vote.q6choice4 = 0;
-            vote.q6choice5 = 0;
-            vote.q6choice6 = 0;
-        });
+    vote_update([&](auto &vote) {
+        vote.iteration = current_iteration();
+        vote.participants = 0;
+        vote.q1average = 0.0;
+        vote.q2average = 0.0;
+        vote.q3average = 0.0;
+        vote.q4choice1 = 0;   // POOL
+        vote.q4choice2 = 0;   // BURN
+        vote.q5average = 0.0;
+        vote.q6choice1 = 0;
+        vote.q6choice2 = 0;
+        vote.q6choice3 = 0;
+        vote.q6choice4 = 0;
+        vote.q6choice5 = 0;
+        vote.q6choice6 = 0;
+        vote.weight.emplace(0);
+        vote.q3sum.emplace(0);
+        vote.amendments.emplace(0);
+    });
+}
+
+// has the user voted in the given iteration?
+bool freeosgov::has_voted(name user, uint32_t iteration) {
+    svr_index svrs_table(get_self(), user.value);
+    auto svr_iterator = svrs_table.begin();
+
+    if (svr_iterator == svrs_table.end()) {
+        return false;
     }
 
+    return svr_iterator->vote0 == iteration ||
+        svr_iterator->vote1 == iteration ||
+        svr_iterator->vote2 == iteration ||
+        svr_iterator->vote3 == iteration ||
+        svr_iterator->vote4 == iteration;
 }
 
 
+// the tokens point into 's', and the list of them is allocated from the action arena
+arena_vector<std::string_view> split (std::string_view s, std::string_view delimiter) {
+    size_t pos_start = 0, pos_end, delim_len = delimiter.length();
+    arena_vector<std::string_view> res;
+
+    while ((pos_end = s.find (delimiter, pos_start)) != std::string_view::npos) {
+        res.push_back (s.substr (pos_start, pos_end - pos_start));
+        pos_start = pos_end + delim_len;
+    }
+
+    res.push_back (s.substr (pos_start));
+    return res;
+}
+
+// parse an integer token without copying it into a string - the whole token must be a number
+int to_int (std::string_view token) {
+    int value = 0;
+    const char *end = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), end, value);
+    check_lazy(ec == std::errc() && ptr == end, [&] { return "invalid number in voteranges: " + std::string(token); });
+    return value;
+}
+
 std::vector<int> parse_vote_ranges(string voteranges) {
     
     // the voteranges string looks like this: q1:0-100,q2:6-30,q5:0-50
     std::vector<int> limits;
 
-    std::vector<std::string> tokenlist = split(voteranges, ",");
+    auto tokenlist = split(voteranges, ",");
+    check(tokenlist.size() == 3, "voteranges must have three questions");
 
-    std::vector q1_param = split(tokenlist[0], ":");
-    std::vector q2_param = split(tokenlist[1], ":");
-    std::vector q5_param = split(tokenlist[2], ":");
+    auto q1_param = split(tokenlist[0], ":");
+    auto q2_param = split(tokenlist[1], ":");
+    auto q5_param = split(tokenlist[2], ":");
+    check(q1_param.size() == 2 && q2_param.size() == 2 && q5_param.size() == 2,
+          "each question in voteranges must be question:range");
 
-    std::vector q1_minmax = split(q1_param[1], "-");
-    std::vector q2_minmax = split(q2_param[1], "-");
-    std::vector q5_minmax = split(q5_param[1], "-");
+    auto q1_minmax = split(q1_param[1], "-");
+    auto q2_minmax = split(q2_param[1], "-");
+    auto q5_minmax = split(q5_param[1], "-");
+    check(q1_minmax.size() == 2 && q2_minmax.size() == 2 && q5_minmax.size() == 2,
+          "each range in voteranges must be min-max");
 
-    limits.push_back (stoi(q1_minmax[0]));
-    limits.push_back (stoi(q1_minmax[1]));
-    limits.push_back (stoi(q2_minmax[0]));
-    limits.push_back (stoi(q2_minmax[1]));
-    limits.push_back (stoi(q5_minmax[0]));
-    limits.push_back (stoi(q5_minmax[1]));
+    limits.push_back (to_int(q1_minmax[0]));
+    limits.push_back (to_int(q1_minmax[1]));
+    limits.push_back (to_int(q2_minmax[0]));
+    limits.push_back (to_int(q2_minmax[1]));
+    limits.push_back (to_int(q5_minmax[0]));
+    limits.push_back (to_int(q5_minmax[1]));
 
     return limits;
 }
 
 // ACTION
-void freeosgov::vote(name user, double q3response) {
+vote_receipt freeosgov::vote(name user, double q3response) {
     
     // TODO: rewrite for reduced voting questions
 
     require_auth(user);
 
-    tick();
+    rollover_check();
 
-    // is the user staked?
-    check(is_staked(user), "voting is not open to unstaked users");
+    // is the user allowed to vote? e.g. staked, and not represented by a proxy
+    modules::eligibility(*this, user);
+
+    // the vote weight is the user's own vote plus any votes delegated to them
+    uint32_t weight = 1;
+    if constexpr (delegate_module::enabled) {
+        proxies_index proxies_table(get_self(), get_self().value);
+        auto proxy_iterator = proxies_table.find(user.value);
+        if (proxy_iterator != proxies_table.end()) {
+            weight += proxy_iterator->delegators;
+        }
+    }
     
     // is the system operational?
     uint32_t this_iteration = current_iteration();
@@ -90,40 +148,55 @@ void freeosgov::vote(name user, double q3response) {
     // are we in the vote period?
     // check(is_action_period("vote"), "it is outside of the vote period");
 
-    // has the user already completed the vote?
+    // has the user already voted? If so, this vote amends their earlier ballot
     svr_index svrs_table(get_self(), user.value);
     auto svr_iterator = svrs_table.begin();
+    bool svr_voted = false;
 
     // if there is no svr record for the user then create it - we will update it at the end of the action
     if (svr_iterator == svrs_table.end()) {
         // emplace
-        svrs_table.emplace(get_self(), [&](auto &svr) { ; });
-        svr_iterator = svrs_table.begin();
+        svr_iterator = svrs_table.emplace(get_self(), [&](auto &svr) { ; });
+        ram_emplaced("svrs"_n, *svr_iterator);
     } else {
-        check(svr_iterator->vote0 != this_iteration &&
-            svr_iterator->vote1 != this_iteration &&
-            svr_iterator->vote2 != this_iteration &&
-            svr_iterator->vote3 != this_iteration &&
-            svr_iterator->vote4 != this_iteration,
-            "user has already voted");
+        svr_voted = svr_iterator->vote0 == this_iteration ||
+            svr_iterator->vote1 == this_iteration ||
+            svr_iterator->vote2 == this_iteration ||
+            svr_iterator->vote3 == this_iteration ||
+            svr_iterator->vote4 == this_iteration;
+    }
+
+    // the ballot also shows a vote in this iteration, in case the svrs row has been reset since
+    ballot_index ballots_table(get_self(), user.value);
+    auto ballot_iterator = ballots_table.begin();
+    bool ballot_voted = ballot_iterator != ballots_table.end() && ballot_iterator->iteration == this_iteration;
+    bool amendment = svr_voted || ballot_voted;
+
+    // an amendment keeps the weight of the original ballot
+    if (amendment) {
+        check(ballot_voted, "user has already voted");
+        weight = ballot_iterator->weight;
     }
 
     // parameter checking
-    // n.b. split function is defined in survey.hpp
 
     // get and parse the vote slider ranges
     // string voteranges = get_parameter(name("voteranges"));
     // std::vector<int> vote_range_values = parse_vote_ranges(voteranges);
 
-    // get the current price of Freeos
-    // get the configuration contract
-    name config_account = name(get_parameter(name("configacct")));
+    // get the current price of Freeos - the local time-weighted average when there are recent observations
+    double current_price = price_twap();
 
-    exchange_index rates_table(config_account, config_account.value);
-    auto rate_iterator = rates_table.begin();
-    check(rate_iterator != rates_table.end(), "current price of Freeos is undefined");
-    double current_price = rate_iterator->currentprice;
-    // double target_price = rate_iterator->targetprice;
+    if (current_price == 0.0) {
+        // otherwise the spot price from the configuration contract
+        name config_account = name(get_parameter(name("configacct")));
+
+        exchange_index rates_table(config_account, config_account.value);
+        auto rate_iterator = rates_table.begin();
+        check(rate_iterator != rates_table.end(), "current price of Freeos is undefined");
+        current_price = rate_iterator->currentprice;
+        // double target_price = rate_iterator->targetprice;
+    }
 
     // calculate the upper bound of locking threshold (q3)
     double lock_factor = get_dparameter(name("lockfactor"));
@@ -135,27 +208,78 @@ void freeosgov::vote(name user, double q3response) {
     }
 
     // argument validation
-    std::string assert_message = "response 3 is out of range (" + to_string(HARD_EXCHANGE_RATE_FLOOR) + " - " + to_string(locking_threshold_upper_limit) + ")";
-    check(q3response >= HARD_EXCHANGE_RATE_FLOOR && q3response <= locking_threshold_upper_limit,   assert_message);
+    check_lazy(q3response >= HARD_EXCHANGE_RATE_FLOOR && q3response <= locking_threshold_upper_limit, [&] {
+        return "response 3 is out of range (" + to_string(HARD_EXCHANGE_RATE_FLOOR) + " - " + to_string(locking_threshold_upper_limit) + ")";
+    });
     
     // store the responses
-    vote_index vote_table(get_self(), get_self().value);
-    auto vote_iterator = vote_table.begin();
-    check(vote_iterator != vote_table.end(), "vote record is not defined");
-
     // process the responses from the user
-    // for multiple choice options, increment to add the user's selection
-    // for running averages, compute new running average
-    vote_table.modify(vote_iterator, get_self(), [&](auto &vote) {
-
-        // question 3
-        vote.q3average = ((vote.q3average * vote.participants) + q3response) / (vote.participants + 1);
+    // aggregates are kept as exact sums so that an amendment can replace the user's previous response
+    uint64_t q3value = (uint64_t) (q3response * VOTE_SCALE + 0.5);
+
+    vote_update([&](auto &vote) {
+        // a row written before the upgrade gets its extensions here, in order
+        uint64_t q3sum = vote.q3_sum();
+        vote.weight.emplace(vote.total_weight());
+        vote.amendments.emplace(vote.amendment_count());
+
+        if (amendment) {
+            // remove the user's previous response
+            q3sum -= ballot_iterator->q3response * weight;
+            vote.amendments.emplace(vote.amendment_count() + 1);
+        } else {
+            // update the number of participants and the total vote weight
+            vote.participants += 1;
+            vote.weight.emplace(vote.total_weight() + weight);
+        }
 
-        // update the number of participants
-        vote.participants += 1;
+        // question 3 - weighted average
+        q3sum += q3value * weight;
+        vote.q3sum.emplace(q3sum);
+        vote.q3average = (double) q3sum / vote.total_weight() / VOTE_SCALE;
 
     }); // end of modify
 
+    const vote_record &votes = voting_record();
+    vote_receipt receipt{this_iteration, q3response, amendment, weight,
+                         votes.q3average, votes.participants, votes.total_weight()};
+
+    // tell indexers about the vote and the new aggregates
+    action(
+        permission_level{get_self(), "active"_n}, get_self(),
+        "logvote"_n,
+        std::make_tuple(user, this_iteration, q3response, amendment, weight,
+                        votes.participants, votes.total_weight(), votes.q3average))
+        .send();
+
+    // store the user's ballot
+    if (ballot_iterator == ballots_table.end()) {
+        ballot_iterator = ballots_table.emplace(get_self(), [&](auto &b) {
+            b.iteration = this_iteration;
+            b.weight = weight;
+            b.q3response = q3value;
+        });
+        ram_emplaced("ballots"_n, *ballot_iterator);
+    } else {
+        ballots_table.modify(ballot_iterator, get_self(), [&](auto &b) {
+            b.iteration = this_iteration;
+            b.weight = weight;
+            b.q3response = q3value;
+        });
+    }
+
+    // an amendment has already been recorded as participation - if the svrs row was reset since, the vote is
+    // recorded in it again below, but the user is not counted twice
+    if (svr_voted) return receipt;
+
+    // add the vote to the user's tally and the leaderboard
+    if (!amendment) {
+        if constexpr (leaderboard_module::enabled) {
+            record_participation(user, 1, asset(0, POINT_CURRENCY_SYMBOL));
+        }
+        record_activity(user, this_iteration);
+    }
+
     // record that the user has responded to this iteration's vote
     uint32_t survey_completed = 0;
     svrs_table.modify(svr_iterator, get_self(), [&](auto &svr) {
@@ -170,14 +294,12 @@ void freeosgov::vote(name user, double q3response) {
 
     // increment the number of participants in this iteration...
     // ... unless they have completed survey, in which case they have already been counted
-    if (survey_completed != this_iteration) {
+    if (!amendment && survey_completed != this_iteration) {
         // increment the number of participants in this iteration
-        system_index system_table(get_self(), get_self().value);
-        auto system_iterator = system_table.begin();
-        check(system_iterator != system_table.end(), "system record is undefined");
-        system_table.modify(system_iterator, get_self(), [&](auto &s) {
+        system_update([&](auto &s) {
             s.participants += 1;
         });
     }
 
+    return receipt;
 }
\ No newline at end of file
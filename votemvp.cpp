@@ -2,58 +2,74 @@
 #include <eosio/eosio.hpp>
 #include <eosio/system.hpp>
 #include "tables.hpp"
+#include "context.hpp"
 #include "config.hpp"
 #include "identity.hpp"
-#include "survey.hpp"
 #include "vote.hpp"
-#include "ratify.hpp"
-#include "points.hpp"
+#include "results.hpp"
+#include "oracle.hpp"
+#include "sweep.hpp"
+#include "ram.hpp"
+#include "stats.hpp"
+#include "events.hpp"
+
+// optional modules - see modules.hpp
+#if MODULE_DELEGATE
+#include "delegate.hpp"
+#endif
+#if MODULE_POLL
+#include "poll.hpp"
+#endif
+#if MODULE_CLAIM
 #include "claim.hpp"
+#endif
+#if MODULE_LEADERBOARD
+#include "leaderboard.hpp"
+#endif
+#if MODULE_IMPORT
+#include "import.hpp"
+#endif
+#if MODULE_MAINTAIN
 #include "maintain.hpp"
+#endif
 
 namespace freedao {
 
 using namespace eosio;
 using namespace std;
 
-const std::string VERSION = "0.1.5mvp";
+constexpr char VERSION[] = "0.1.5mvp";
 
 // ACTION
 void freeosgov::version() {
 
-  string version_message = "Version = " + VERSION + ", Iteration = " + to_string(current_iteration());
+  string version_message = string("Version = ") + VERSION + ", Iteration = " + to_string(current_iteration());
 
   check(false, version_message);
 }
 
 // ACTION
-void freeosgov::init() {
+init_receipt freeosgov::init() {
 
   require_auth(get_self());
 
-  system_index system_table(get_self(), get_self().value);
-  auto system_iterator = system_table.begin();
-  if (system_iterator == system_table.end()) {
+  system_index &system_table = system_records();
+  if (system_table.begin() == system_table.end()) {
     // insert system record
-    system_table.emplace(get_self(), [&](auto &sys) {
+    auto new_iterator = system_table.emplace(get_self(), [&](auto &sys) {
       sys.init = current_time_point();
       sys.cls = asset(0, POINT_CURRENCY_SYMBOL);
       });
+    ram_emplaced("system"_n, *new_iterator);
   } else {
     // modify system record
-    system_table.modify(system_iterator, get_self(), [&](auto &sys) { sys.init = current_time_point(); });
+    system_update([&](auto &sys) { sys.init = current_time_point(); });
   }
 
-  // create the survey, vote and ratify records if they don't already exist
-  // survey
-  // survey_init();
-
-  // vote
-  vote_init();
-
-  // ratify
-  // ratify_init();
+  // create the records of each enabled module (e.g. survey, vote and ratify) if they don't already exist
+  modules::init(*this);
 
+  return init_receipt{system_record().init, current_iteration()};
 }
 
 
@@ -64,16 +80,14 @@ bool freeosgov::is_action_period(string action) {
   // default return is false
   bool result = false;
 
-  string action_parameter_start = action + "start";
-  string action_parameter_end = action + "end";
-  string err_msg_start = action_parameter_start + " is undefined";
-  string err_msg_end = action_parameter_end + " is undefined";
+  // the parameter names are built in the action arena
+  arena_string action_parameter_start(action.begin(), action.end());
+  action_parameter_start += "start";
+  arena_string action_parameter_end(action.begin(), action.end());
+  action_parameter_end += "end";
 
   // get the start of freeos system time
-  system_index system_table(get_self(), get_self().value);
-  auto system_iterator = system_table.begin();
-  check(system_iterator != system_table.end(), "system record is undefined");
-  time_point init = system_iterator->init;
+  time_point init = system_record().init;
 
   // how far are we into the current iteration?
   uint64_t now_secs = current_time_point().sec_since_epoch();
@@ -81,15 +95,8 @@ bool freeosgov::is_action_period(string action) {
   uint32_t iteration_secs = (now_secs - init_secs) % ITERATION_LENGTH_SECONDS;
 
   // get the config parameters for surveystart and surveyend
-  parameters_index parameters_table(get_self(), get_self().value);
-
-  auto parameter_iterator = parameters_table.find(name(action_parameter_start).value);
-  check(parameter_iterator != parameters_table.end(), err_msg_start);
-  uint32_t action_start = stoi(parameter_iterator->value);
-
-  parameter_iterator = parameters_table.find(name(action_parameter_end).value);
-  check(parameter_iterator != parameters_table.end(), err_msg_end);
-  uint32_t action_end = stoi(parameter_iterator->value);
+  uint32_t action_start = stoi(get_parameter(name(std::string_view(action_parameter_start))));
+  uint32_t action_end = stoi(get_parameter(name(std::string_view(action_parameter_end))));
   
   if (iteration_secs >= action_start && iteration_secs <= action_end) {
     result = true;
@@ -128,6 +135,10 @@ uint16_t freeosgov::current_iteration() {
 // AirClaim-style iteration calculation
 // return the current iteration record
 uint32_t freeosgov::current_iteration() {
+  // the calendar is read at most once per action
+  count_lookup();
+  if (context.iteration) return *context.iteration;
+
   uint32_t this_iteration = 0;
 
   uint64_t now = current_time_point().time_since_epoch()._count;
@@ -135,6 +146,7 @@ uint32_t freeosgov::current_iteration() {
   name config_account = name(get_parameter(name("configacct")));
 
   // find iteration that matches current time
+  count_read();
   iterations_index iterations_table(config_account,
                                     config_account.value);
   auto start_index = iterations_table.get_index<"start"_n>();
@@ -151,6 +163,7 @@ uint32_t freeosgov::current_iteration() {
     this_iteration = iteration_iterator->iteration_number;
   }
 
+  context.iteration = this_iteration;
   return this_iteration;
 }
 
@@ -183,16 +196,11 @@ void freeosgov::tick() {
 } */
 
 
-// ACTION
-void freeosgov::tick() {
+// bring the system record up to the current iteration - returns true if the iteration has changed
+bool freeosgov::iteration_update() {
 
   // what iteration is in the system table?
-  system_index system_table(get_self(), get_self().value);
-  auto system_iterator = system_table.begin();
-  check(system_iterator != system_table.end(),
-        "system record is not found");
-
-  uint32_t old_iteration = system_iterator->iteration;
+  uint32_t old_iteration = system_record().iteration;
   uint32_t new_iteration = current_iteration();
 
   if (new_iteration != old_iteration) {
@@ -200,16 +208,35 @@ void freeosgov::tick() {
     trigger_new_iteration(new_iteration);
 
     // write the new iteration value back to the statistics record
-    system_table.modify(system_iterator, get_self(), [&](auto &sys) {
+    system_update([&](auto &sys) {
       sys.iteration = new_iteration;
     });
+    return true;
   }
+
+  return false;
+}
+
+// user actions never pay for the rollover - it is left to cron, which the keeper pushes from the operations account
+void freeosgov::rollover_check() {
+  check(system_record().iteration == current_iteration(), "rollover pending");
+}
+
+// ACTION
+void freeosgov::tick() {
+  iteration_update();
 }
 
 
 // ACTION
 void freeosgov::cron() {
-  tick();
+  iteration_update();
+
+  // periodic work of each enabled module, e.g. closing polls that have reached their closing time
+  modules::cron(*this);
+
+  // remove the participation records of long-inactive users
+  sweep(get_parameter_or(name("sweepbudget"), SWEEP_BUDGET));
 }
 
 // tidy up at the end of an iteration - save SVR data in the reward record
@@ -219,38 +246,47 @@ void freeosgov::trigger_new_iteration(uint32_t new_iteration) {
   if (new_iteration == 1) return;
 
   // record/update the old and new iterations - and take snapshot of the CLS at this point
-  system_index system_table(get_self(), get_self().value);
-  auto system_iterator = system_table.begin();
-  check(system_iterator != system_table.end(), "system record is undefined");
+  const auto &system_row = system_record();
 
   // capture the data we need from the system, vote and ratify records
   // 1. system record
-  uint32_t participants = system_iterator->participants;
-  uint32_t old_iteration = system_iterator->iteration;
+  uint32_t participants = system_row.participants;
+  uint32_t old_iteration = system_row.iteration;
 
   // 2. vote record
-  vote_index vote_table(get_self(), get_self().value);
-  auto vote_iterator = vote_table.begin();
-  check(vote_iterator != vote_table.end(), "vote record is undefined");
+  const vote_record &votes = voting_record();
   // locking threshold
-  double locking_threshold = vote_iterator->q3average;
+  double locking_threshold = votes.q3average;
 
   // find the locking threshold quorum
   std::string locking_quorum_str = get_parameter(name("lockquorum"));
   uint32_t  locking_quorum = stoi(locking_quorum_str);
 
-  if (vote_iterator->participants >= locking_quorum) {
-    // write the locking threshold back to the exchangerate table on freeoscfg
-    action transfer_action = action(
-        permission_level{get_self(), "active"_n}, name(freeosconfig_acct),
-        "targetrate"_n,
-        std::make_tuple(locking_threshold));
+  // delegated votes count towards the quorum
+  bool quorum = votes.total_weight() >= locking_quorum;
 
-    transfer_action.send();
-  }
+  // send the locking threshold, with the other outcomes of the iteration, to freeoscfg
+  results_send(old_iteration, gov_outcome{"lockthresh"_n, old_iteration, locking_threshold, votes.total_weight(), quorum});
+
+  // tell indexers about the result of the iteration
+  action(
+      permission_level{get_self(), "active"_n}, get_self(),
+      "logrollover"_n,
+      std::make_tuple(old_iteration, new_iteration, participants, votes.participants,
+                      votes.total_weight(), locking_threshold, quorum))
+      .send();
   
+  // archive the iteration's counters
+  stats_archive(old_iteration);
+
+  // end-of-iteration work of each enabled module, e.g. the leaderboard snapshot
+  modules::rollover(*this, old_iteration);
+
+  // record the RAM growth of each table over the iteration
+  ram_rollover();
+
   // reset the survey, vote and ratify records, ready for the new iteration
-  vote_reset();
+  modules::reset(*this);
 
 }
 
@@ -1,20 +1,99 @@
 #pragma once
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+#include "tables.hpp"
+#include "modules.hpp"
+#include "arena.hpp"
+
+#include <map>
+#include <optional>
 
 namespace freedao {
 using namespace eosio;
 using namespace std;
 
-#define _STRINGIZE(x) #x
-#define STRINGIZE(x) _STRINGIZE(x)
+// the configuration contract - FREEOSCONFIG is a string literal passed by compile.sh
+constexpr name FREEOSCONFIG_ACCT = name(FREEOSCONFIG);
+
+// count the lookups of rows and values held in the action context, and the database reads made for them - printed at
+// the end of each action by the -DBENCH build, for tools/bench. Lookups that the context answers need no read.
+#ifdef BENCH
+inline uint32_t context_lookups = 0;
+inline uint32_t context_reads = 0;
+inline void count_lookup() { context_lookups++; }
+inline void count_read() { context_reads++; }
+#else
+inline void count_lookup() {}
+inline void count_read() {}
+#endif
+
+// a single-row table's row, read once during an action and written back at most once at the end of it
+template <typename Table, typename Row> class cached_row {
+public:
+  // the table, constructed on first use
+  Table &table(name self) {
+    if (!rows) rows.emplace(self, self.value);
+    return *rows;
+  }
+
+  // the row - checks that it exists
+  const Row &get(name self, const char *undefined) {
+    eosio::check(load(self), undefined);
+    return *row;
+  }
+
+  // change the row in memory - the change is written by flush()
+  template <typename F> void modify(name self, const char *undefined, F &&updater) {
+    eosio::check(load(self), undefined);
+    updater(*row);
+    dirty = true;
+  }
+
+  // write the row back if it has changed
+  void flush(name self) {
+    if (!dirty) return;
+    rows->modify(*iterator, self, [&](auto &r) { r = *row; });
+    dirty = false;
+  }
 
-std::string freeosconfig_acct = STRINGIZE(FREEOSCONFIG);
+private:
+  std::optional<Table> rows;
+  std::optional<typename Table::const_iterator> iterator;
+  std::optional<Row> row;
+  bool dirty = false;
+
+  bool load(name self) {
+    count_lookup();
+    if (row) return true;
+
+    Table &t = table(self);
+    count_read();
+    auto found = t.begin();
+    if (found == t.end()) return false;
+
+    iterator = found;
+    row = *found;
+    return true;
+  }
+};
+
+// rows and values loaded during an action - see context.hpp
+struct action_context {
+  cached_row<system_index, system> system_row;
+  cached_row<vote_index, vote_record> vote_row;
+  std::map<uint64_t, std::optional<std::string>> parameters;  // a parameter that is not set is held as nullopt
+  std::map<uint64_t, double> dparameters;
+  std::optional<uint32_t> iteration;
+  std::map<uint64_t, bool> staked;
+  std::map<uint64_t, std::pair<int64_t, int64_t>> ram;  // rows and bytes added to each table, keyed by table name
+};
 
 class[[eosio::contract("votemvp")]] freeosgov : public contract {
 
 public:
   using contract::contract;
+  ~freeosgov();
 
   /**
    * version action.
@@ -22,13 +101,22 @@ public:
    * @details Prints the version of this contract.
    */
   [[eosio::action]] void version();
-  [[eosio::action]] void init();
+  [[eosio::action]] init_receipt init();
   [[eosio::action]] void tick();
   [[eosio::action]] void cron();
+  bool iteration_update();
+  void rollover_check();
   void trigger_new_iteration(uint32_t new_iterationß);
 
-  // maintain actions TODO: remove in production version
-  // [[eosio::action]] void maintain(string action, name user, vector<name> removees);
+  // table maintenance actions/functions (In maintain.hpp)
+#if MODULE_MAINTAIN
+  [[eosio::action]] tableop_receipt tableop(name table, name op, uint32_t budget, uint64_t scope, vector<name> users);
+#endif
+  template <typename T> uint32_t table_truncate(name table, uint64_t scope, uint32_t budget);
+  template <typename Parent, typename Child> uint32_t table_truncate_linked(name table, name child, uint32_t budget);
+  template <typename T> uint32_t table_rewrite(name table, uint64_t scope, uint64_t &position, uint32_t budget);
+  template <typename T> uint32_t row_rewrite(name table, uint64_t scope);
+  uint32_t user_tableop(name table, name op, name user);
 
   // identity actions
   // [[eosio::action]] void reguser(name user);
@@ -36,10 +124,15 @@ public:
   bool is_staked(name user);
 
   // config actions
-  [[eosio::action]] void paramupsert(name paramname, std::string value);
-  [[eosio::action]] void paramerase(name paramname);
-  [[eosio::action]] void dparamupsert(name paramname, double value);
-  [[eosio::action]] void dparamerase(name paramname);
+  [[eosio::action]] param_receipt paramupsert(name paramname, std::string value);
+  [[eosio::action]] param_receipt paramerase(name paramname);
+  [[eosio::action]] param_receipt dparamupsert(name paramname, double value);
+  [[eosio::action]] param_receipt dparamerase(name paramname);
+  [[eosio::action]] batch_receipt parambatch(vector<param_change> changes);
+  bool parameter_upsert(parameters_index &parameters_table, name paramname, const string &value);
+  void parameter_erase(parameters_index &parameters_table, name paramname);
+  bool dparameter_upsert(dparameters_index &dparameters_table, name paramname, double dvalue);
+  void dparameter_erase(dparameters_index &dparameters_table, name paramname);
   // [[eosio::action]] void transfadd(name account);
   // [[eosio::action]] void transferase(name account);
   // [[eosio::action]] void minteradd(name account);
@@ -55,9 +148,16 @@ public:
   // void survey_reset();
 
   // vote actions/functions
-  [[eosio::action]] void vote(name user, double q3response);
+  [[eosio::action]] vote_receipt vote(name user, double q3response);
   void vote_init();
   void vote_reset();
+  bool has_voted(name user, uint32_t iteration);
+
+  // delegation actions (In delegate.hpp)
+#if MODULE_DELEGATE
+  [[eosio::action]] void delegate(name user, name proxy);
+  [[eosio::action]] void undelegate(name user);
+#endif
 
   // ratify actions/functions
   // [[eosio::action]] void ratify(name user, bool ratify_vote);
@@ -66,6 +166,64 @@ public:
 
   // claim actions/functions
   // [[eosio::action]] void claim(name user);
+#if MODULE_CLAIM
+  [[eosio::action]] void claimroot(uint32_t iteration, checksum256 root, uint32_t leaves, asset total);
+  [[eosio::action]] void claimproof(name user, uint32_t iteration, uint32_t index, asset amount, vector<checksum256> proof);
+#endif
+
+  // poll actions/functions (In poll.hpp)
+#if MODULE_POLL
+  [[eosio::action]] uint64_t propose(string question, uint8_t type, double minimum, double maximum, uint8_t choices, time_point opens, time_point closes);
+  [[eosio::action]] void pollvote(name user, uint64_t id, double response);
+#endif
+  void poll_finalise();
+
+  // sweeper actions/functions (In sweep.hpp)
+  [[eosio::action]] uint32_t seedactives(vector<name> users);
+  void sweep(uint32_t budget);
+  void record_activity(name user, uint32_t iteration);
+
+  // RAM accounting actions/functions (In ram.hpp)
+  [[eosio::action, eosio::read_only]] std::vector<ram_stat> ramreport();
+  [[eosio::action]] void ramseed(name table, int64_t rows, int64_t bytes);
+  template <typename T> void ram_emplaced(name table, const T &row);
+  template <typename T> void ram_erased(name table, const T &row);
+  void ram_resized(name table, int64_t bytes);
+  void ram_track(name table, int64_t rows, int64_t bytes);
+  void ram_flush();
+  void ram_rollover();
+
+  // event actions (In events.hpp) - inline notifications for indexers
+  [[eosio::action]] void logvote(name user, uint32_t iteration, double q3response, bool amendment, uint32_t weight,
+                                 uint32_t participants, uint32_t total_weight, double q3average);
+  [[eosio::action]] void logrollover(uint32_t old_iteration, uint32_t new_iteration, uint32_t participants,
+                                     uint32_t voters, uint32_t vote_weight, double locking_threshold, bool quorum);
+
+  // governance results functions (In results.hpp)
+#ifdef CONFIG_GOVRESULTS
+  void result_pending(const gov_outcome &outcome);
+#endif
+  void results_send(uint32_t iteration, const gov_outcome &outcome);
+
+  // statistics actions (In stats.hpp)
+  [[eosio::action, eosio::read_only]] iteration_stats statsreport(uint32_t iteration);
+  iteration_stats stats_collect(uint32_t iteration);
+  void stats_archive(uint32_t iteration);
+
+  // AirClaim import actions (In import.hpp)
+#if MODULE_IMPORT
+  [[eosio::action]] import_receipt airimport(vector<name> users);
+#endif
+
+  // price oracle actions/functions (In oracle.hpp)
+  [[eosio::action]] void priceupdate(double price);
+  double price_twap();
+
+  // leaderboard functions (In leaderboard.hpp)
+  void record_participation(name user, uint32_t votes, asset claimed);
+  void leaderboard_update(name user, uint32_t votes, asset claimed);
+  void leaderboard_snapshot(uint32_t iteration);
+  void leaderboard_remove(name user);
 
   /* points actions and functions
   [[eosio::action]] void create(const name &issuer, const asset &maximum_supply);
@@ -87,9 +245,23 @@ public:
   bool is_registered(name user);
   uint32_t user_last_active_iteration(name user);
   // bool is_user_alive(name user);
+  std::optional<string> parameter_value(name parameter);
   string get_parameter(name parameter);
+  string get_parameter_or(name parameter, const string &fallback);
+  uint32_t get_parameter_or(name parameter, uint32_t fallback);
   double get_dparameter(name parameter);
   // asset calculate_user_cls_addition();
+
+  // per-action context (In context.hpp)
+  system_index &system_records();
+  const system &system_record();
+  template <typename F> void system_update(F &&updater);
+  vote_index &vote_records();
+  const vote_record &voting_record();
+  template <typename F> void vote_update(F &&updater);
+
+private:
+  action_context context;
 };
 
 } // end of namespace freedao
\ No newline at end of file